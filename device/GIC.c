@@ -7,6 +7,10 @@
 
 #include "GIC.h"
 
+#if defined( CONFIG_SMP )
+GICC_t* GICC0 = ( GICC_t* )( 0x1E000100 );
+GICD_t* GICD0 = ( GICD_t* )( 0x1E001000 );
+#else
 GICC_t* GICC0 = ( GICC_t* )( 0x1E000000 );
 GICD_t* GICD0 = ( GICD_t* )( 0x1E001000 );
 GICC_t* GICC1 = ( GICC_t* )( 0x1E010000 );
@@ -15,3 +19,4 @@ GICC_t* GICC2 = ( GICC_t* )( 0x1E020000 );
 GICD_t* GICD2 = ( GICD_t* )( 0x1E021000 );
 GICC_t* GICC3 = ( GICC_t* )( 0x1E030000 );
 GICD_t* GICD3 = ( GICD_t* )( 0x1E031000 );
+#endif
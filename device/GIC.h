@@ -75,7 +75,7 @@ typedef struct {
           RO RSVD( 5, 0x030C, 0x03FC ); // 0x030C...0x03FC : reserved
           RW uint32_t IPRIORITYR[ 24 ]; // 0x0400...0x045C : priority
           RO RSVD( 6, 0x0460, 0x07FC ); // 0x0460...0x07FC : reserved
-          RO uint32_t  ITARGETSR[ 24 ]; // 0x0800...0x085C : processor target
+          RW uint32_t  ITARGETSR[ 24 ]; // 0x0800...0x085C : processor target
           RO RSVD( 7, 0x0860, 0x0BFC ); // 0x0760...0x0BFC : reserved
           RW uint32_t      ICFGR0;      // 0x0C00          : configuration
           RW uint32_t      ICFGR1;      // 0x0C04          : configuration
@@ -88,6 +88,30 @@ typedef struct {
           RO RSVD( 9, 0x0F04, 0x0FFC ); // 0x0F04...0x0FFC : reserved
 } GICD_t;
 
+/* The multi-core (i.e., vexpress-a9, per CONFIG_SMP) platform instead
+ * has a single GIC, integrated into the Cortex-A9 MPCore: its interface
+ * (which is banked, st. each core sees its own) and distributor are part
+ * of the private memory region, and the interrupt IDs differ per the
+ * motherboard (i.e., V2M-P1) documentation at
+ *
+ * http://infocenter.arm.com/help/topic/com.arm.doc.dui0447j/index.html
+ *
+ * IDs 0 to 15 are Software Generated Interrupts (SGIs), i.e., raised
+ * by writing to SGIR rather than by a device.
+ */
+
+#if defined( CONFIG_SMP )
+#define GIC_SOURCE_TIMER0 ( 34 )
+#define GIC_SOURCE_TIMER1 ( 35 )
+
+#define GIC_SOURCE_UART0  ( 37 )
+#define GIC_SOURCE_UART1  ( 38 )
+#define GIC_SOURCE_UART2  ( 39 )
+#define GIC_SOURCE_UART3  ( 40 )
+
+#define GIC_SOURCE_PS20   ( 44 )
+#define GIC_SOURCE_PS21   ( 45 )
+#else
 #define GIC_SOURCE_TIMER0 ( 36 )
 #define GIC_SOURCE_TIMER1 ( 37 )
 #define GIC_SOURCE_TIMER2 ( 73 )
@@ -100,6 +124,7 @@ typedef struct {
 
 #define GIC_SOURCE_PS20   ( 52 )
 #define GIC_SOURCE_PS21   ( 53 )
+#endif
 
 /* Per Table 4.2 (for example: the information is in several places) of
  * 
@@ -111,11 +136,13 @@ typedef struct {
 
 extern GICC_t* GICC0;
 extern GICD_t* GICD0;
+#if !defined( CONFIG_SMP )
 extern GICC_t* GICC1;
 extern GICD_t* GICD1;
 extern GICC_t* GICC2;
 extern GICD_t* GICD2;
 extern GICC_t* GICC3;
 extern GICD_t* GICD3;
+#endif
 
 #endif
@@ -21,6 +21,8 @@ void mmu_unable();
 
 // flush   TLB
 void mmu_flush();
+// flush   TLB of every CPU, i.e., broadcast (which needs the multiprocessing extensions, e.g., of the Cortex-A9)
+void mmu_flush_all();
 
 // configure MMU: set page table pointer #0 to x
 void mmu_set_ptr0( uint32_t* x );
@@ -26,6 +26,7 @@
 .global mmu_unable
 
 .global mmu_flush
+.global mmu_flush_all
 
 .global mmu_set_ptr0
 .global mmu_set_ptr1
@@ -49,6 +50,14 @@ mmu_flush:           mov   r0,     #0x0
 
                      mov   pc, lr                @ return
 
+mmu_flush_all:       mov   r0,     #0x0
+                     dsb                         @ complete page table writes
+                     mcr   p15, 0, r0, c8, c3, 0 @ write TLBIALLIS
+                     dsb                         @ complete invalidation, on every CPU
+                     isb
+
+                     mov   pc, lr                @ return
+
 mmu_set_ptr0:        mcr   p15, 0, r0, c2, c0, 0 @ write TTBR0
 
                      mov   pc, lr                @ return
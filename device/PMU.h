@@ -0,0 +1,51 @@
+/* Copyright (C) 2017 Daniel Page <csdsp@bristol.ac.uk>
+ *
+ * Use of this source code is restricted per the CC BY-NC-ND license, a copy of 
+ * which can be found via http://creativecommons.org (and should be included as 
+ * LICENSE.txt within the associated archive or repository).
+ */
+
+#ifndef __PMU_H
+#define __PMU_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "device.h"
+
+/* As outlined in Chapter C12 of
+ *
+ * http://infocenter.arm.com/help/index.jsp?topic=/com.arm.doc.ddi0406c/index.html
+ *
+ * the Performance Monitors Unit (PMU) of each processor houses a cycle
+ * counter, plus (on the Cortex-A8 and Cortex-A9) 4 event counters, each
+ * of which counts whichever event it is configured to; each is 32-bit,
+ * and wraps silently.  Table C12-4 lists the common event numbers; note
+ * QEMU only implements some of them, and those it does not never count.
+ */
+
+#define PMU_COUNTERS         ( 4 )
+
+#define PMU_EVENT_L1I_REFILL ( 0x01 ) // L1 instruction cache refill
+#define PMU_EVENT_L1D_REFILL ( 0x03 ) // L1 data        cache refill
+#define PMU_EVENT_L1D_ACCESS ( 0x04 ) // L1 data        cache access
+#define PMU_EVENT_INSTR      ( 0x08 ) // instruction architecturally executed
+#define PMU_EVENT_EXC        ( 0x09 ) // exception taken
+#define PMU_EVENT_BR_MISPRED ( 0x10 ) // branch mispredicted (or not predicted)
+#define PMU_EVENT_CYCLES     ( 0x11 ) // cycle
+
+//  enable PMU, i.e., reset then enable cycle counter and every event counter
+void     pmu_enable();
+// disable PMU
+void     pmu_unable();
+
+// configure event counter n to count event x
+void     pmu_set_event( int n, uint32_t x );
+
+// read cycle counter
+uint32_t pmu_cycles();
+// read event counter n
+uint32_t pmu_count( int n );
+
+#endif
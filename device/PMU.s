@@ -0,0 +1,62 @@
+/* Copyright (C) 2017 Daniel Page <csdsp@bristol.ac.uk>
+ *
+ * Use of this source code is restricted per the CC BY-NC-ND license, a copy of 
+ * which can be found via http://creativecommons.org (and should be included as 
+ * LICENSE.txt within the associated archive or repository).
+ */
+
+/* Section B4.1.116 onward of
+ *
+ * http://infocenter.arm.com/help/index.jsp?topic=/com.arm.doc.ddi0406c/index.html
+ *
+ * describes the PMU registers in co-processor 15, all of which use CRn
+ * = c9: for example, if we use an mrc instruction
+ *
+ * id = p15, opc1 = 0, CRn = c9, CRm = c13, opc2 = 0
+ *
+ * then we are reading the PMCCNTR register, i.e., the cycle counter.
+ * An event counter is accessed indirectly, by first selecting it via
+ * PMSELR then reading or writing PMXEVTYPER or PMXEVCNTR.
+ */
+
+.global pmu_enable
+.global pmu_unable
+
+.global pmu_set_event
+
+.global pmu_cycles
+.global pmu_count
+
+pmu_enable:          mrc   p15, 0, r0, c9, c12, 0 @ read  PMCR
+                     orr   r0, r0, #0x7           @ set   PMCR[ C, P, E ] = 1 => reset counters, enable
+                     bic   r0, r0, #0x8           @ set   PMCR[ D       ] = 0 => count every cycle
+                     mcr   p15, 0, r0, c9, c12, 0 @ write PMCR
+                     mov   r0, #0x8000000F
+                     mcr   p15, 0, r0, c9, c12, 1 @ write PMCNTENSET => enable cycle counter and event counters 0...3
+                     mcr   p15, 0, r0, c9, c12, 3 @ write PMOVSR     => clear overflow flags
+
+                     mov   pc, lr                 @ return
+
+pmu_unable:          mrc   p15, 0, r0, c9, c12, 0 @ read  PMCR
+                     bic   r0, r0, #0x1           @ set   PMCR[ E ] = 0 => disable
+                     mcr   p15, 0, r0, c9, c12, 0 @ write PMCR
+
+                     mov   pc, lr                 @ return
+
+pmu_set_event:       mcr   p15, 0, r0, c9, c12, 5 @ write PMSELR     => select event counter n
+                     isb
+                     mcr   p15, 0, r1, c9, c13, 1 @ write PMXEVTYPER => count event x
+                     mov   r1, #0
+                     mcr   p15, 0, r1, c9, c13, 2 @ write PMXEVCNTR  => reset
+
+                     mov   pc, lr                 @ return
+
+pmu_cycles:          mrc   p15, 0, r0, c9, c13, 0 @ read  PMCCNTR
+
+                     mov   pc, lr                 @ return
+
+pmu_count:           mcr   p15, 0, r0, c9, c12, 5 @ write PMSELR     => select event counter n
+                     isb
+                     mrc   p15, 0, r0, c9, c13, 2 @ read  PMXEVCNTR
+
+                     mov   pc, lr                 @ return
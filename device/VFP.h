@@ -0,0 +1,50 @@
+/* Copyright (C) 2017 Daniel Page <csdsp@bristol.ac.uk>
+ *
+ * Use of this source code is restricted per the CC BY-NC-ND license, a copy of 
+ * which can be found via http://creativecommons.org (and should be included as 
+ * LICENSE.txt within the associated archive or repository).
+ */
+
+#ifndef __VFP_H
+#define __VFP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "device.h"
+
+/* As outlined in Chapter B1.11 of
+ *
+ * http://infocenter.arm.com/help/index.jsp?topic=/com.arm.doc.ddi0406c/index.html
+ *
+ * the VFP and NEON (aka. Advanced SIMD) extensions share one register
+ * file, i.e., 32 64-bit registers D0...D31 (aliased as 16 128-bit Q0...Q15
+ * registers), plus the FPSCR status and control register.  Both are
+ * accessed via co-processors 10 and 11: each is disabled out of reset,
+ * so must be granted access via CPACR, then enabled via FPEXC[ EN ].
+ * Whenever FPEXC[ EN ] = 0, any VFP or NEON instruction (other than to
+ * access FPEXC itself) raises an undefined instruction exception.
+ */
+
+typedef struct {
+  uint64_t d[ 32 ];          // D0...D31
+  uint32_t fpscr;            // FPSCR
+} vfp_t;
+
+// grant access to co-processors 10 and 11 (from every mode, including USR)
+void vfp_init();
+
+//  enable VFP and NEON, i.e., set   FPEXC[ EN ]
+void vfp_enable();
+// disable VFP and NEON, i.e., clear FPEXC[ EN ]
+void vfp_unable();
+// return true iff. VFP and NEON are enabled
+bool vfp_enabled();
+
+// save    registers into x
+void vfp_save   (       vfp_t* x );
+// restore registers from x
+void vfp_restore( const vfp_t* x );
+
+#endif
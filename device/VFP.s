@@ -0,0 +1,66 @@
+/* Copyright (C) 2017 Daniel Page <csdsp@bristol.ac.uk>
+ *
+ * Use of this source code is restricted per the CC BY-NC-ND license, a copy of 
+ * which can be found via http://creativecommons.org (and should be included as 
+ * LICENSE.txt within the associated archive or repository).
+ */
+
+/* Section B4.1.40 of
+ *
+ * http://infocenter.arm.com/help/index.jsp?topic=/com.arm.doc.ddi0406c/index.html
+ *
+ * describes CPACR, whose cp10 and cp11 fields (i.e., bits 20...23) grant
+ * access to the VFP and NEON extensions; Section B6.1.47 then describes
+ * FPEXC, whose EN field (i.e., bit 30) enables them.  Note that vmrs and
+ * vmsr access FPEXC and FPSCR, whereas vstm and vldm transfer a block of
+ * (at most 16) D registers to or from memory.
+ */
+
+.fpu neon
+
+.global vfp_init
+
+.global vfp_enable
+.global vfp_unable
+.global vfp_enabled
+
+.global vfp_save
+.global vfp_restore
+
+vfp_init:            mrc   p15, 0, r0, c1, c0, 2  @ read  CPACR
+                     orr   r0, r0, #0x00F00000    @ set   CPACR[ cp10, cp11 ] = 11 => full access
+                     mcr   p15, 0, r0, c1, c0, 2  @ write CPACR
+                     isb
+
+                     mov   pc, lr                 @ return
+
+vfp_enable:          vmrs  r0, fpexc              @ read  FPEXC
+                     orr   r0, r0, #0x40000000    @ set   FPEXC[ EN ] = 1 =>  enable
+                     vmsr  fpexc, r0              @ write FPEXC
+
+                     mov   pc, lr                 @ return
+
+vfp_unable:          vmrs  r0, fpexc              @ read  FPEXC
+                     bic   r0, r0, #0x40000000    @ set   FPEXC[ EN ] = 0 => disable
+                     vmsr  fpexc, r0              @ write FPEXC
+
+                     mov   pc, lr                 @ return
+
+vfp_enabled:         vmrs  r0, fpexc              @ read  FPEXC
+                     ubfx  r0, r0, #30, #1        @ extract FPEXC[ EN ]
+
+                     mov   pc, lr                 @ return
+
+vfp_save:            vstmia r0!, { d0-d15  }      @ store D0...D15
+                     vstmia r0!, { d16-d31 }      @ store D16...D31
+                     vmrs  r1, fpscr              @ read  FPSCR
+                     str   r1, [ r0 ]             @ store FPSCR
+
+                     mov   pc, lr                 @ return
+
+vfp_restore:         vldmia r0!, { d0-d15  }      @ load  D0...D15
+                     vldmia r0!, { d16-d31 }      @ load  D16...D31
+                     ldr   r1, [ r0 ]             @ load  FPSCR
+                     vmsr  fpscr, r1              @ write FPSCR
+
+                     mov   pc, lr                 @ return
@@ -0,0 +1,65 @@
+import argparse, logging, os, struct, sys
+
+# The disk starts with a directory (per kernel/image.h) of fixed-size
+# entries, each of which captures the name, address and size of an
+# image; the first entry with an empty name terminates the directory.
+# Each image is then stored, aligned to a block, after the directory.
+
+DIR_ENTRIES  = 64
+DIR_NAME     = 24
+DIR_ENTRY    = struct.Struct( '<%dsLL' % ( DIR_NAME ) )
+
+# Pack each file given into the disk, named after the file itself (e.g.,
+# programs/cat.elf is named cat); this replaces the directory and images
+# wholesale, but leaves the rest of the disk intact.
+
+def pack( fd, files ) :
+  entries = [] ; address = DIR_ENTRIES * DIR_ENTRY.size
+
+  for f in files :
+    name = os.path.splitext( os.path.basename( f ) )[ 0 ]
+    data = open( f, 'rb' ).read()
+
+    if( len( name ) >= DIR_NAME    ) :
+      raise ValueError( 'name %s too long'  % ( name ) )
+    if( len( entries ) == DIR_ENTRIES ) :
+      raise ValueError( 'too many images'             )
+
+    address = ( ( address + args.block_len - 1 ) // args.block_len ) * args.block_len
+
+    if( ( address + len( data ) ) > ( args.block_num * args.block_len ) ) :
+      raise ValueError( 'image %s too large' % ( name ) )
+
+    os.lseek( fd, address, os.SEEK_SET ) ; os.write( fd, data )
+
+    logging.info( 'pack %d bytes -> address %X_{(16)} = %s' % ( len( data ), address, name ) )
+
+    entries.append( DIR_ENTRY.pack( name.encode(), address, len( data ) ) ) ; address += len( data )
+
+  entries += [ DIR_ENTRY.pack( b'', 0, 0 ) ] * ( DIR_ENTRIES - len( entries ) )
+
+  os.lseek( fd, 0, os.SEEK_SET ) ; os.write( fd, b''.join( entries ) )
+
+if ( __name__ == '__main__' ) :
+  # parse command line arguments
+
+  parser = argparse.ArgumentParser()
+
+  parser.add_argument( '--file',      type =  str, action = 'store'      )
+
+  parser.add_argument( '--block-num', type =  int, action = 'store'      )
+  parser.add_argument( '--block-len', type =  int, action = 'store'      )
+
+  parser.add_argument( 'images',      type =  str, nargs  = '*'          )
+
+  args = parser.parse_args()
+
+  logging.basicConfig( stream = sys.stdout, level = logging.INFO, format = '%(filename)s : %(asctime)s : %(message)s', datefmt = '%d/%m/%y @ %H:%M:%S' )
+
+  # open disk image, then pack images into it
+
+  fd = os.open( args.file, os.O_RDWR )
+
+  pack( fd, args.images )
+
+  os.close( fd )
@@ -0,0 +1,114 @@
+import argparse, bisect, collections, logging, struct, subprocess, sys
+
+# A profiler dump (per kernel/prof.h) is a header (magic, number of
+# samples and number dropped) followed by the samples; several dumps may
+# be concatenated, or interleaved with trace dumps (per kernel/trace.h),
+# which are skipped, e.g., if the file captures UART3 across several
+# drains.
+
+PROF_MAGIC   = 0x50524631
+PROF_HEADER  = struct.Struct( '<LLL'   )
+PROF_SAMPLE  = struct.Struct( '<LLhBB' )
+
+TRACE_MAGIC  = 0x54524331
+TRACE_EVENT  = struct.Struct( '<LBBhL' )
+
+MODE_USR     = 0x10
+
+VM_BASE      = 0x40000000 # per kernel/vm.h, programs loaded from disk execute in a window the symbols of image.elf do not cover
+VM_TOP       = 0x40100000
+
+# Parse each dump in data x into a list of samples, each a tuple of PC,
+# LR, PID, mode and CPU; also return the number of samples dropped.
+
+def parse( x ) :
+  r = [] ; i = 0 ; dropped = 0
+
+  while( ( i + PROF_HEADER.size ) <= len( x ) ) :
+    magic, n, m = PROF_HEADER.unpack_from( x, i )
+
+    if( magic == TRACE_MAGIC ) :
+      i += PROF_HEADER.size + ( m * TRACE_EVENT.size ) ; continue # skip trace dump, whose header captures the number of events last
+    if( magic != PROF_MAGIC  ) :
+      i += 1 ; continue # resynchronise, e.g., after a truncated dump
+
+    i += PROF_HEADER.size ; dropped += m
+
+    for j in range( n ) :
+      if( ( i + PROF_SAMPLE.size ) > len( x ) ) :
+        logging.warning( 'dump truncated' ) ; break
+
+      r.append( PROF_SAMPLE.unpack_from( x, i ) ) ; i += PROF_SAMPLE.size
+
+  return r, dropped
+
+# Read the (sorted) function symbols of ELF file f, using nm.
+
+def symbols( f ) :
+  r = []
+
+  for line in subprocess.check_output( [ args.nm, '-n', f ] ).decode().splitlines() :
+    t = line.split()
+
+    if( len( t ) == 3 and t[ 1 ] in 'Tt' and not t[ 2 ].startswith( '$' ) ) :
+      r.append( ( int( t[ 0 ], 16 ), t[ 2 ] ) )
+
+  return r
+
+def lookup( syms, addrs, x ) :
+  if( x >= VM_BASE and x < VM_TOP ) :
+    return 'image'
+
+  i = bisect.bisect_right( addrs, x ) - 1
+
+  return syms[ i ][ 1 ] if ( i >= 0 ) else '0x%08X' % ( x )
+
+# Fold list of samples x into stacks, each rooted at the process sampled,
+# then (iff. it was in the kernel) a kernel frame, then the caller per LR
+# (iff. in USR mode, and it differs) and the function per PC; there are
+# no frame pointers, so the caller is approximate.
+
+def fold( x, syms ) :
+  r = collections.Counter() ; addrs = [ a for ( a, _ ) in syms ]
+
+  for ( pc, lr, pid, mode, cpu ) in x :
+    stack = [ 'idle' if ( pid < 0 ) else ( 'P%d' % ( pid ) ) ]
+
+    if( mode != MODE_USR ) :
+      stack.append( 'kernel' )
+
+    f = lookup( syms, addrs, pc ) ; g = lookup( syms, addrs, lr )
+
+    if( mode == MODE_USR and g != f ) :
+      stack.append( g )
+
+    stack.append( f ) ; r[ ';'.join( stack ) ] += 1
+
+  return r
+
+if ( __name__ == '__main__' ) :
+  # parse command line arguments
+
+  parser = argparse.ArgumentParser()
+
+  parser.add_argument( '--file',   type = str, action = 'store'                      )
+  parser.add_argument( '--elf',    type = str, action = 'store', default = 'image.elf' )
+  parser.add_argument( '--nm',     type = str, action = 'store', default = 'nm'        )
+  parser.add_argument( '--output', type = str, action = 'store'                      )
+
+  args = parser.parse_args()
+
+  logging.basicConfig( stream = sys.stderr, level = logging.INFO, format = '%(filename)s : %(asctime)s : %(message)s', datefmt = '%d/%m/%y @ %H:%M:%S' )
+
+  # read dump, symbolise samples, then write folded stacks (e.g., for flamegraph.pl)
+
+  samples, dropped = parse( open( args.file, 'rb' ).read() )
+
+  logging.info( 'parsed %d samples (%d dropped)' % ( len( samples ), dropped ) )
+
+  stacks = fold( samples, symbols( args.elf ) )
+
+  fd = open( args.output, 'w' ) if ( args.output ) else sys.stdout
+
+  for ( stack, n ) in sorted( stacks.items(), key = lambda x : -x[ 1 ] ) :
+    fd.write( '%s %d\n' % ( stack, n ) )
@@ -0,0 +1,144 @@
+import argparse, json, logging, struct, sys
+
+# A trace dump (per kernel/trace.h) is a sequence of rings, each of which
+# is a header (magic, CPU and number of events) followed by the events;
+# several dumps may be concatenated, e.g., if the file captures UART3
+# across several drains, or interleaved with profiler dumps (per
+# kernel/prof.h), which are skipped.  Times are in microseconds, per the
+# clock, so need no conversion for Chrome trace.
+
+TRACE_MAGIC  = 0x54524331
+TRACE_HEADER = struct.Struct( '<LLL'   )
+TRACE_EVENT  = struct.Struct( '<LBBhL' )
+
+PROF_MAGIC   = 0x50524631
+PROF_SAMPLE  = struct.Struct( '<LLhBB' )
+
+TRACE_SWITCH, TRACE_IRQ_ENTER, TRACE_IRQ_EXIT, TRACE_SVC_ENTER, TRACE_SVC_EXIT, TRACE_FORK, TRACE_EXIT, TRACE_WAIT, TRACE_WAKE = range( 9 )
+
+SYSCALLS     = [ 'yield', 'write', 'read', 'fork', 'exit', 'exec', 'kill', 'nice', 'shm_open', 'mmap', 'shm_unlink',
+                 'writev', 'readv', 'open', 'close', 'lseek', 'pipe', 'dup2', 'spawn', 'thread_create', 'thread_join',
+                 'sched_setclass', 'sched_setattr', 'sched_setslice', 'sched_setquantum', 'getstats', 'cycles', 'trace', 'prof', 'getpid' ]
+
+PROCESS_BASE = 1000 # Chrome trace pid of the track for each process, offset st. it differs from that of each CPU
+
+# Parse each ring in data x into a list of events, each a tuple of time
+# (unwrapped st. it increases monotonically per CPU), type, CPU, PID and
+# argument.  A ring is only nearly in time order, since the entry to a
+# light system call is recorded, with the time it was made, once the call
+# completes: each time is therefore unwrapped relative to the latest so
+# far, i.e., a step of at least 2^31 either way crosses a wrap.
+
+def parse( x ) :
+  r = [] ; i = 0 ; last = {} ; wraps = {}
+
+  while( ( i + TRACE_HEADER.size ) <= len( x ) ) :
+    magic, cpu, n = TRACE_HEADER.unpack_from( x, i )
+
+    if( magic == PROF_MAGIC  ) :
+      i += TRACE_HEADER.size + ( cpu * PROF_SAMPLE.size ) ; continue # skip profiler dump, whose header captures the number of samples in place of the CPU
+    if( magic != TRACE_MAGIC ) :
+      i += 1 ; continue # resynchronise, e.g., after a truncated dump
+
+    i += TRACE_HEADER.size
+
+    for j in range( n ) :
+      if( ( i + TRACE_EVENT.size ) > len( x ) ) :
+        logging.warning( 'ring for CPU %d truncated' % ( cpu ) ) ; break
+
+      time, type, cpu, pid, arg = TRACE_EVENT.unpack_from( x, i ) ; i += TRACE_EVENT.size
+
+      step = ( time - last.get( cpu, time ) ) & 0xFFFFFFFF ; w = wraps.get( cpu, 0 )
+
+      if  ( step <  0x80000000 ) : # later than the latest, so the latest iff. not in the past
+        if( time < last.get( cpu, time ) ) :
+          w += 1 ; wraps[ cpu ] = w
+
+        last[ cpu ] = time
+      elif( time > last[ cpu ] ) : # earlier than the latest, but before it wrapped
+        w -= 1
+
+      r.append( ( time + ( w << 32 ), type, cpu, pid, arg ) )
+
+  return sorted( r )
+
+def name( pid ) :
+  return 'idle' if ( pid < 0 ) else ( 'P%d' % ( pid ) )
+
+# Convert list of events x into Chrome trace events: each CPU has a track
+# showing which process it executes (plus nested interrupts and system
+# calls), and each process a track showing when (and on which CPU) it
+# executes.  Also return the latency between each process being woken
+# and then dispatched.
+
+def convert( x ) :
+  r = [] ; running = {} ; woken = {} ; latency = [] ; pids = set() ; cpus = set()
+
+  def slice( cpu, pid, lo, hi ) :
+    r.append( { 'name' : name( pid ), 'ph' : 'X', 'ts' : lo, 'dur' : hi - lo, 'pid' : cpu, 'tid' : 0 } )
+
+    if( pid >= 0 ) :
+      r.append( { 'name' : 'CPU %d' % ( cpu ), 'ph' : 'X', 'ts' : lo, 'dur' : hi - lo, 'pid' : PROCESS_BASE + pid, 'tid' : cpu } ) ; pids.add( pid )
+
+  for ( time, type, cpu, pid, arg ) in x :
+    cpus.add( cpu )
+
+    if   ( type == TRACE_SWITCH    ) :
+      if( cpu in running ) :
+        slice( cpu, running[ cpu ][ 0 ], running[ cpu ][ 1 ], time )
+
+      running[ cpu ] = ( arg if ( arg < 0x80000000 ) else -1, time )
+
+      if( arg in woken ) :
+        latency.append( ( time - woken.pop( arg ), arg, cpu, time ) )
+
+    elif( type == TRACE_IRQ_ENTER ) :
+      r.append( { 'name' : 'irq %d' % ( arg ), 'ph' : 'B', 'ts' : time, 'pid' : cpu, 'tid' : 1 } )
+    elif( type == TRACE_IRQ_EXIT  ) :
+      r.append( { 'name' : 'irq %d' % ( arg ), 'ph' : 'E', 'ts' : time, 'pid' : cpu, 'tid' : 1 } )
+    elif( type == TRACE_SVC_ENTER ) :
+      r.append( { 'name' : SYSCALLS[ arg ] if ( arg < len( SYSCALLS ) ) else 'svc %d' % ( arg ), 'ph' : 'B', 'ts' : time, 'pid' : cpu, 'tid' : 1, 'args' : { 'pid' : pid } } )
+    elif( type == TRACE_SVC_EXIT  ) :
+      r.append( { 'name' : SYSCALLS[ arg ] if ( arg < len( SYSCALLS ) ) else 'svc %d' % ( arg ), 'ph' : 'E', 'ts' : time, 'pid' : cpu, 'tid' : 1 } )
+    else :
+      what = { TRACE_FORK : 'fork', TRACE_EXIT : 'exit', TRACE_WAIT : 'wait', TRACE_WAKE : 'wake' }[ type ]
+
+      r.append( { 'name' : what, 'ph' : 'i', 's' : 't', 'ts' : time, 'pid' : cpu, 'tid' : 0, 'args' : { 'pid' : pid, 'arg' : arg } } )
+
+      if( type == TRACE_WAKE ) :
+        woken[ arg ] = time
+
+  for cpu in cpus :
+    r.append( { 'name' : 'process_name', 'ph' : 'M', 'pid' : cpu, 'args' : { 'name' : 'CPU %d' % ( cpu ) } } )
+    r.append( { 'name' :  'thread_name', 'ph' : 'M', 'pid' : cpu, 'tid' : 0, 'args' : { 'name' : 'process' } } )
+    r.append( { 'name' :  'thread_name', 'ph' : 'M', 'pid' : cpu, 'tid' : 1, 'args' : { 'name' : 'kernel'  } } )
+  for pid in pids :
+    r.append( { 'name' : 'process_name', 'ph' : 'M', 'pid' : PROCESS_BASE + pid, 'args' : { 'name' : name( pid ) } } )
+
+  return r, sorted( latency, reverse = True )
+
+if ( __name__ == '__main__' ) :
+  # parse command line arguments
+
+  parser = argparse.ArgumentParser()
+
+  parser.add_argument( '--file',     type = str, action = 'store'              )
+  parser.add_argument( '--output',   type = str, action = 'store'              )
+  parser.add_argument( '--outliers', type = int, action = 'store', default = 8 )
+
+  args = parser.parse_args()
+
+  logging.basicConfig( stream = sys.stderr, level = logging.INFO, format = '%(filename)s : %(asctime)s : %(message)s', datefmt = '%d/%m/%y @ %H:%M:%S' )
+
+  # read dump, convert into Chrome trace, then report wake-up latency outliers
+
+  events = parse( open( args.file, 'rb' ).read() )
+
+  logging.info( 'parsed %d events' % ( len( events ) ) )
+
+  trace, latency = convert( events )
+
+  json.dump( { 'traceEvents' : trace, 'displayTimeUnit' : 'ms' }, open( args.output, 'w' ) if ( args.output ) else sys.stdout )
+
+  for ( t, pid, cpu, time ) in latency[ : args.outliers ] :
+    logging.info( 'wake -> dispatch latency %d us: %s on CPU %d at %d us' % ( t, name( pid ), cpu, time ) )
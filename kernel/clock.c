@@ -0,0 +1,12 @@
+#include "clock.h"
+
+void     clock_init() {
+  TIMER0->Timer2Load  = 0xFFFFFFFF; // select period = 2^32 ticks
+  TIMER0->Timer2Ctrl  = 0x00000002; // select 32-bit   timer
+  TIMER0->Timer2Ctrl |= 0x00000040; // select periodic timer
+  TIMER0->Timer2Ctrl |= 0x00000080; // enable          timer
+}
+
+uint32_t clock_now() {
+  return ~TIMER0->Timer2Value;      // count down from 2^32 - 1, so invert to count up
+}
@@ -0,0 +1,22 @@
+#ifndef __CLOCK_H
+#define __CLOCK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "SP804.h"
+
+/* The second timer of TIMER0 (the first being used for the timer tick)
+ * is configured as a free-running 32-bit counter, st. it measures time
+ * in cycles of the SP804 clock (i.e., 1 MHz), and wraps every 2^32
+ * cycles.  Differences between readings are therefore valid as long as
+ * they are computed using unsigned (i.e., modulo 2^32) arithmetic.
+ */
+
+// start counter
+extern void     clock_init();
+// return number of cycles since counter was started
+extern uint32_t clock_now();
+
+#endif
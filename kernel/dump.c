@@ -0,0 +1,61 @@
+#include "dump.h"
+
+static uint8_t  dump_buf[ DUMP_SIZE ];
+static uint32_t dump_len = 0; // number of bytes staged
+static uint32_t dump_pos = 0; // number of bytes drained
+
+/* Move at most DUMP_BURST bytes into the UART FIFO, then unmask the TX
+ * interrupt iff. some remain: once the FIFO drains, the interrupt handler
+ * will call this function again (cf. tty_drain, which is otherwise the
+ * same but unbounded, since a tty ring is small).
+ */
+
+static void dump_drain() {
+  for( int i = 0; i < DUMP_BURST && dump_pos < dump_len && PL011_can_putc( DUMP_UART ); i++ ) {
+    PL011_putc( DUMP_UART, dump_buf[ dump_pos++ ], false );
+  }
+
+  if( dump_pos < dump_len ) {
+    DUMP_UART->IMSC |=  0x00000020; // unmask TX interrupt
+  }
+  else {
+    DUMP_UART->IMSC &= ~0x00000020; //   mask TX interrupt
+  }
+}
+
+void dump_init() {
+  DUMP_UART->ICR  = 0x000007FF; // clear all interrupts
+  DUMP_UART->IMSC = 0x00000000; //  mask all interrupts
+}
+
+bool dump_open() {
+  if( dump_pos < dump_len ) {
+    return false;
+  }
+
+  dump_len = 0; dump_pos = 0;
+
+  return true;
+}
+
+bool dump_put( const void* x, int n ) {
+  if( n > ( DUMP_SIZE - dump_len ) ) {
+    return false;
+  }
+
+  memcpy( &dump_buf[ dump_len ], x, n ); dump_len += n;
+
+  return true;
+}
+
+void dump_close() {
+  dump_drain();
+}
+
+void dump_handler_irq() {
+  if( DUMP_UART->MIS & 0x00000020 ) { // TX interrupt
+    DUMP_UART->ICR = 0x00000020;
+
+    dump_drain();
+  }
+}
@@ -0,0 +1,38 @@
+#ifndef __DUMP_H
+#define __DUMP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string.h>
+
+#include "PL011.h"
+
+/* A binary dump (e.g., of the trace rings, or of profiler samples) is
+ * staged into a buffer, then drained to DUMP_UART by the UART interrupt
+ * handler, a FIFO's worth of bytes at a time.  Neither the system call
+ * requesting a dump nor any handler therefore busy-waits on the UART
+ * while holding the kernel lock, and whatever was staged can be reused
+ * (e.g., recorded into again) at once.  Only one dump is drained at a
+ * time: another cannot be staged until the last byte of the previous one
+ * has been written.
+ */
+
+#define DUMP_UART  ( UART3 )
+#define DUMP_SIZE  ( 0xC400 ) // bytes staged per dump, i.e., enough for every trace ring or every profiler sample
+#define DUMP_BURST (     16 ) // bytes written per interrupt, i.e., the UART FIFO depth
+
+// initialise the dump, i.e., UART, state
+extern void dump_init();
+// start staging a dump; return false iff. the previous one is still draining
+extern bool dump_open();
+// stage n bytes from x; return false iff. they do not fit
+extern bool dump_put( const void* x, int n );
+// stop staging a dump, and start draining it
+extern void dump_close();
+
+// handle UART interrupt, i.e., continue draining
+extern void dump_handler_irq();
+
+#endif
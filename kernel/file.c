@@ -0,0 +1,130 @@
+#include "file.h"
+
+file_t files[ MAX_FILES ];
+
+// -------------------------------------------------------------------------------------------------------------------
+// tty files: data = tty
+
+static int tty_file_read ( file_t* f,       uint8_t* x, int n ) {
+  int r = tty_read ( ( tty_t* )( f->data ), x, n );
+
+  return ( r == 0 && n > 0 ) ? FILE_AGAIN : r; // nothing received yet
+}
+
+static int tty_file_write( file_t* f, const uint8_t* x, int n ) {
+  int r = tty_write( ( tty_t* )( f->data ), x, n );
+
+  return ( r == 0 && n > 0 ) ? FILE_AGAIN : r; // no room to queue
+}
+
+static const file_ops_t tty_ops = {
+  .read  = tty_file_read,
+  .write = tty_file_write,
+  .mmap  = NULL,
+  .close = NULL
+};
+
+// -------------------------------------------------------------------------------------------------------------------
+// disk files: data = NULL; offset = byte address on disk
+
+/* The disk can only be read or written a block at a time, so a read or
+ * write is split into (possibly partial) blocks; a partial block write
+ * must read the block first st. the rest of it is preserved.  Note that
+ * the disk is accessed synchronously.
+ */
+
+static int disk_block_len = 0;
+
+static int disk_file_read ( file_t* f,       uint8_t* x, int n ) {
+  int len = disk_block_len; uint8_t t[ len ];
+
+  for( int i = 0; i < n; ) {
+    uint32_t a = f->offset / len, o = f->offset % len;
+    int      k = ( ( len - o ) < ( n - i ) ) ? ( len - o ) : ( n - i );
+
+    if( disk_rd( a, t, len ) != DISK_SUCCESS ) {
+      return ( i > 0 ) ? i : FILE_ERROR;
+    }
+
+    memcpy( &x[ i ], &t[ o ], k ); i += k; f->offset += k;
+  }
+
+  return n;
+}
+
+static int disk_file_write( file_t* f, const uint8_t* x, int n ) {
+  int len = disk_block_len; uint8_t t[ len ];
+
+  for( int i = 0; i < n; ) {
+    uint32_t a = f->offset / len, o = f->offset % len;
+    int      k = ( ( len - o ) < ( n - i ) ) ? ( len - o ) : ( n - i );
+
+    if( ( k < len ) && ( disk_rd( a, t, len ) != DISK_SUCCESS ) ) {
+      return ( i > 0 ) ? i : FILE_ERROR;
+    }
+
+    memcpy( &t[ o ], &x[ i ], k );
+
+    if( disk_wr( a, t, len ) != DISK_SUCCESS ) {
+      return ( i > 0 ) ? i : FILE_ERROR;
+    }
+
+    i += k; f->offset += k;
+  }
+
+  return n;
+}
+
+static const file_ops_t disk_ops = {
+  .read  = disk_file_read,
+  .write = disk_file_write,
+  .mmap  = NULL,
+  .close = NULL
+};
+
+// -------------------------------------------------------------------------------------------------------------------
+
+file_t* file_alloc( file_type_t t, const file_ops_t* ops, void* x ) {
+  for( int i = 0; i < MAX_FILES; i++ ) {
+    if( files[ i ].refs == 0 ) {
+      files[ i ].type   = t;
+      files[ i ].ops    = ops;
+      files[ i ].refs   = 1;
+      files[ i ].data   = x;
+      files[ i ].offset = 0;
+
+      return &files[ i ];
+    }
+  }
+
+  return NULL; // If no free file
+}
+
+file_t* file_open ( const char* x ) {
+  if     ( 0 == strcmp( x, "tty0" ) ) {
+    return file_alloc( FILE_TTY, &tty_ops, &ttys[ 0 ] );
+  }
+  else if( 0 == strcmp( x, "tty1" ) ) {
+    return file_alloc( FILE_TTY, &tty_ops, &ttys[ 1 ] );
+  }
+  else if( 0 == strcmp( x, "disk" ) ) {
+    // Query the block length once, since doing so means a round trip to the disk
+    if( disk_block_len <= 0 ) {
+      disk_block_len = disk_get_block_len();
+    }
+
+    return ( disk_block_len > 0 ) ? file_alloc( FILE_DISK, &disk_ops, NULL ) : NULL;
+  }
+
+  return NULL;
+}
+
+void    file_dup  ( file_t* f ) {
+  f->refs++;
+}
+
+void    file_close( file_t* f ) {
+  if( --f->refs == 0 && f->ops->close != NULL ) {
+    f->ops->close( f );
+  }
+}
@@ -0,0 +1,79 @@
+#ifndef __FILE_H
+#define __FILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string.h>
+
+#include  "disk.h"
+
+#include   "tty.h"
+
+/* Every file descriptor held by a process refers to a file object, which
+ * captures
+ *
+ * - the type of file (e.g., a tty, a shm region or one end of a pipe),
+ * - a table of operations (or ops) st. system calls such as read and write
+ *   can be dispatched without special-casing each type, where a NULL entry
+ *   means the operation is unsupported,
+ * - a reference count, st. the same file can be shared by several file
+ *   descriptors (e.g., after a fork), and is only released once the last
+ *   is closed, and
+ * - type-specific state.
+ *
+ * A read or write operation returns the number of bytes read or written,
+ * FILE_ERROR on failure, or FILE_AGAIN iff. it would have to block: the
+ * caller should then wait on the file data (which acts as wait channel)
+ * before retrying.
+ */
+
+#define MAX_FILES  32
+#define MAX_FDS     8 // maximum number of file descriptors per process
+
+#define FILE_ERROR ( -1 )
+#define FILE_AGAIN ( -2 )
+
+#define  STDIN_FILENO 0
+#define STDOUT_FILENO 1
+#define STDERR_FILENO 2
+
+#define SEEK_SET    0
+#define SEEK_CUR    1
+
+typedef enum {
+  FILE_TTY,
+  FILE_SHM,
+  FILE_DISK,
+  FILE_PIPE
+} file_type_t;
+
+typedef struct file file_t;
+
+typedef struct {
+  int   ( *read  )( file_t* f,       uint8_t* x, int n ); // read  up to n bytes into x
+  int   ( *write )( file_t* f, const uint8_t* x, int n ); // write up to n bytes from x
+  void* ( *mmap  )( file_t* f );                          // return address file is mapped at
+  void  ( *close )( file_t* f );                          // release once the last reference is closed
+} file_ops_t;
+
+struct file {
+        file_type_t   type; // type of file
+  const  file_ops_t*   ops; // operations supported by file
+                int   refs; // number of references (e.g., file descriptors)
+               void*  data; // type-specific state, and wait channel
+           uint32_t offset; // current offset (iff. seekable)
+};
+
+// allocate a file of type t, with operations ops and state x; return NULL iff. none are free
+extern file_t* file_alloc( file_type_t t, const file_ops_t* ops, void* x );
+// open the device file named x (i.e., "tty0", "tty1" or "disk"); return NULL iff. unknown
+extern file_t* file_open ( const char* x );
+
+// add    a reference to   file f
+extern void    file_dup  ( file_t* f );
+// remove a reference from file f, releasing it iff. it was the last
+extern void    file_close( file_t* f );
+
+#endif
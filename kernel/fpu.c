@@ -0,0 +1,70 @@
+#include "fpu.h"
+#include "hilevel.h"
+
+static pcb_t* fpu_owner[ MAX_CPUS ]; // process whose registers each CPU holds, or NULL iff. none
+
+// Process p owns, and is current on, CPU c
+static bool fpu_live( pcb_t* p, int c ) {
+  return p != NULL && fpu_owner[ c ] == p && p->vfp_cpu == c;
+}
+
+void fpu_init() {
+  vfp_init();
+  vfp_unable();
+
+  fpu_owner[ cpu_id() ] = NULL;
+}
+
+void fpu_switch( pcb_t* prev, pcb_t* next ) {
+  int c = cpu_id();
+
+  if( MAX_CPUS > 1 && fpu_live( prev, c ) && vfp_enabled() ) {
+    vfp_save( &prev->vfp );
+  }
+
+  // Enable iff. the registers are those of next already, st. the first use by any other process traps
+  if( fpu_live( next, c ) ) {
+    vfp_enable();
+  }
+  else {
+    vfp_unable();
+  }
+}
+
+bool fpu_trap( pcb_t* p ) {
+  int c = cpu_id();
+
+  if( vfp_enabled() ) {
+    return false;
+  }
+
+  vfp_enable();
+
+  if( !fpu_live( p, c ) ) {
+    // Only with 1 CPU are the registers of the owner not saved as it is switched out
+    if( MAX_CPUS == 1 && fpu_owner[ c ] != NULL ) {
+      vfp_save( &fpu_owner[ c ]->vfp );
+    }
+
+    vfp_restore( &p->vfp );
+
+    fpu_owner[ c ] = p; p->vfp_cpu = c;
+  }
+
+  return true;
+}
+
+void fpu_copy( pcb_t* p, pcb_t* q ) {
+  if( fpu_live( p, cpu_id() ) ) {
+    vfp_save( &q->vfp );                           // i.e., from the registers, since they are enabled and current
+  }
+  else {
+    memcpy( &q->vfp, &p->vfp, sizeof( vfp_t ) );
+  }
+}
+
+void fpu_release( pcb_t* p ) {
+  for( int c = 0; c < MAX_CPUS; c++ ) {
+    if( fpu_owner[ c ] == p ) fpu_owner[ c ] = NULL;
+  }
+}
@@ -0,0 +1,43 @@
+#ifndef __FPU_H
+#define __FPU_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include   "VFP.h"
+
+#include   "smp.h"
+
+/* The VFP/NEON registers (see VFP.h) of each process are switched lazily,
+ * st. a process which never uses them (which includes the kernel) costs
+ * nothing: each CPU records which process owns its registers, i.e., whose
+ * state they hold, and only enables VFP/NEON while that process executes.
+ * Any other process which then uses them raises an undefined instruction
+ * exception, upon which the registers are saved into the PCB of the owner
+ * (iff. any), those of the process restored from its PCB, and it becomes
+ * the owner; the instruction is then retried.  Note that
+ *
+ * - with more than 1 CPU, a process may migrate (and use its registers on
+ *   another CPU) whenever it is not executing, so its registers are
+ *   saved as it is switched out instead (iff. it is the owner, and VFP/NEON
+ *   was enabled, i.e., they may have changed), and
+ * - each process records which CPU last restored its registers, st. the
+ *   owner of a CPU is only current iff. it matches, i.e., the process has
+ *   not since used (and so changed) them on another.
+ */
+
+struct pcb;
+
+// enable access to VFP/NEON (on this CPU), initially with no owner
+extern void fpu_init();
+// switch from process prev to process next (either of which may be NULL), on this CPU
+extern void fpu_switch( struct pcb* prev, struct pcb* next );
+// handle trap by process p, executing on this CPU; return false iff. VFP/NEON was enabled, i.e., the instruction is truly undefined
+extern bool fpu_trap( struct pcb* p );
+// copy registers of process p, executing on this CPU, into process q (e.g., for fork)
+extern void fpu_copy( struct pcb* p, struct pcb* q );
+// release registers of process p (e.g., as it terminates), st. no CPU treats it as the owner
+extern void fpu_release( struct pcb* p );
+
+#endif
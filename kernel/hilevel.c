@@ -7,144 +7,1350 @@
 
 #include "hilevel.h"
 
-pcb_t procTab[ MAX_PROCS ]; pcb_t* executing = NULL;
+pcb_t procTab[ MAX_PROCS ]; cpu_t cpus[ MAX_CPUS ];
 
+/* The process executing on, and idle process of, whichever CPU refers to
+ * them: with a single CPU, these are simply the one executing and idle
+ * process.
+ */
+
+#define executing ( cpus[ cpu_id() ].current  )
+#define idle      ( cpus[ cpu_id() ].idle_pcb )
+
+ctx_t* svc_ctx[ MAX_CPUS ]; // execution context preserved by the system call each CPU is handling, iff. any (see hilevel_handler_seg)
+
+// Record a trace event (see trace.h) wrt. the executing process, as of now or as of time t
+#define TRACE(    x, y    ) trace_event(    x, ( executing != NULL ) ? executing->pid : -1, y    )
+#define TRACE_AT( x, y, t ) trace_event_at( x, ( executing != NULL ) ? executing->pid : -1, y, t )
+
+extern uint32_t tos_idle;
 extern uint32_t tos_procs;
-extern void main_console();
 
-region regions[ MAX_SHM ] = { 0 };
+#define IDLE_SIZE 0x00000100 // size of idle process stack, per CPU
+
+#ifndef CONFIG_INIT
+#define CONFIG_INIT "console"  // program executed by the 0-th PCB, e.g., bench rather than console (per make bench)
+#endif
+
+// Executed iff. every other process is waiting (e.g., for I/O)
+void main_idle() {
+  while( 1 ) {
+    asm volatile( "wfi" ); // wait for interrupt
+  }
+}
+
+// -------------------------------------------------------------------------------------------------------------------
+// Getters
+
+pcb_t* get_pcb ( pid_t pid ) {
+  for( int i = 0; i < MAX_PROCS; i++ ) {
+    if( procTab[i].pid == pid ) return &procTab[i];
+  }
+  return NULL;
+}
+
+// Get the process a PCB belongs to, i.e., the PCB itself unless it is a thread
+pcb_t* get_process( pcb_t* pcb ) {
+  return ( pcb->group != NULL ) ? ( pcb_t* )( pcb->group ) : pcb;
+}
+
+// Get the file referred to by file descriptor fd of the executing process
+file_t* get_file( int fd ) {
+  if( fd < 0 || fd >= MAX_FDS ) return NULL;
+  return get_process( executing )->fd[ fd ];
+}
+
+// Get the lowest free file descriptor of the executing process
+int get_free_fd() {
+  for( int i = 0; i < MAX_FDS; i++ ) {
+    if( get_process( executing )->fd[ i ] == NULL ) return i;
+  }
+
+  return -1; // If no free file descriptor
+}
+
+// A process is executing iff. the CPU it last executed on still is, even if it has since terminated (e.g., been killed by another)
+bool is_executing( pcb_t* pcb ) {
+  return cpus[ pcb->cpu ].current == pcb;
+}
+
+// Get the next free PCB in process table
+int get_free_pcb_index() {
+  for( int i = 0; i < MAX_PROCS; i++ ) {
+    if( ( procTab[ i ].status == STATUS_INVALID || procTab[ i ].status == STATUS_TERMINATED ) && !is_executing( &procTab[ i ] ) ) return i;
+  }
+
+  return -1; // If no free PCB
+}
+
+// A process can be scheduled iff. it isn't waiting, terminated or invalid
+bool is_runnable( pcb_t* pcb ) {
+  return pcb->status == STATUS_CREATED || pcb->status == STATUS_READY || pcb->status == STATUS_EXECUTING;
+}
+
+/* Find the program named x: either it is registered (i.e., linked into
+ * the kernel), or else it is an image loaded from disk, which needs a
+ * fresh address space vm to map it into (vs. NULL for a registered
+ * program).  Return false iff. there is no such program, or no room for
+ * it.
+ */
+
+bool get_program( const char* x, uint32_t* entry, int* priority, vm_t** vm ) {
+  const program_t* p = registry_find( x );
+
+  if( p != NULL ) {
+    *entry = ( uint32_t )( p->entry ); *priority = p->priority; *vm = NULL;
+
+    return p->stack <= ( PROC_SIZE - PROC_TLS - ARGS_SIZE );
+  }
+
+  image_t* image = image_get( x );
+
+  if( image != NULL && ( *vm = vm_alloc( image ) ) != NULL ) {
+    *entry = image->entry;     *priority = 1;
+
+    return true;
+  }
+  if( image != NULL ) {
+    image_put( image );
+  }
+
+  return false;
+}
+
+void wake( void* c );
+
+/* Close every file descriptor and release the address space of a process
+ * (or thread), reset its PCB and indicate termination, then wake whatever
+ * is joining it.  Terminating a process terminates each of its threads.
+ */
+
+void terminate( pcb_t* pcb ) {
+  for( int i = 0; i < MAX_PROCS && pcb->group == NULL; i++ ) {
+    if( procTab[ i ].group == pcb ) terminate( &procTab[ i ] );
+  }
+
+  for( int i = 0; i < MAX_FDS; i++ ) {
+    if( pcb->fd[ i ] != NULL ) file_close( pcb->fd[ i ] );
+  }
+  if( pcb->vm != NULL ) vm_free( pcb->vm );
+
+  rq_remove( pcb );
+  sched_exit( pcb );
+  fpu_release( pcb );
+
+  TRACE( TRACE_EXIT, pcb->pid );
+
+  int cpu = pcb->cpu; // retained, st. it is clear whether a CPU is still executing the PCB
+  mem_zero( pcb, sizeof( pcb_t ) );
+  pcb->status = STATUS_TERMINATED;
+  pcb->cpu    = cpu;
+
+  wake( pcb );
+}
+
+// -------------------------------------------------------------------------------------------------------------------
+// Scheduling
+
+void dispatch( ctx_t* ctx, pcb_t* prev, pcb_t* next ) {
+  if( NULL != prev ) {
+    ctx_copy( &prev->ctx, ctx );                // preserve execution context of P_{prev}
+  }
+  if( NULL != next ) {
+    ctx_copy( ctx, &next->ctx );                // restore  execution context of P_{next}
+    asm volatile( "mcr p15, 0, %0, c13, c0, 3 \n" // set TPIDRURO = TLS of P_{next}
+                :
+                : "r" (next->tls) );
+    vm_switch( next->vm );                      // map address space of P_{next} (iff. any, and not mapped already, e.g., for a thread of P_{prev})
+
+    if( next != prev ) next->stats.switches++;
+
+    TRACE( TRACE_SWITCH, next->pid );
+  }
+
+  if( prev != next ) fpu_switch( prev, next );   // switch VFP/NEON registers lazily, i.e., only once P_{next} uses them
+
+#if defined( CONFIG_DEBUG )
+  char prev_pid = ( prev == NULL ) ? '?' : ( prev == &idle ) ? 'I' : '0' + prev->pid;
+  char next_pid = ( next == NULL ) ? '?' : ( next == &idle ) ? 'I' : '0' + next->pid;
+
+  PL011_putc( UART0, '[',      true );
+  PL011_putc( UART0, prev_pid, true );
+  PL011_putc( UART0, '-',      true );
+  PL011_putc( UART0, '>',      true );
+  PL011_putc( UART0, next_pid, true );
+  PL011_putc( UART0, ']',      true );
+  PL011_putc( UART0, '\n',     true );
+#endif
+
+  executing = next;                             // update   executing process to P_{next}
+
+  return;
+}
+
+// Using whichever scheduling class each process is in (i.e., EDF, then priority+age or fair-share), wrt. the runqueue of this CPU (see sched.h)
+void schedule( ctx_t* ctx ) {
+  pcb_t* prev = executing;
+  pcb_t* next;
+
+  // Account for time executing process spent executing, then return it to the runqueue iff. it can continue
+  rq_charge( cpu_id(), prev );
+  if( prev != NULL && prev != &idle && is_runnable( prev ) ) rq_push( cpu_id(), prev );
+
+  // Pick runnable process with highest priority; if there is none, steal one from another CPU, or else run the idle process
+  if( ( next = rq_pick( cpu_id() ) ) == NULL && rq_steal( cpu_id() ) ) next = rq_pick( cpu_id() );
+  if(   next                         == NULL                          ) next = &idle;
+
+  // Switch context, then arm one-shot timer for whatever budget it has (iff. any)
+  dispatch( ctx, prev, next );
+  rq_arm( cpu_id(), next );
+  if( prev != NULL && prev->status == STATUS_EXECUTING ) prev->status = STATUS_READY;
+  next->status = STATUS_EXECUTING;
+  return;
+}
+
+/* Block the executing process until wake is called with the same wait
+ * channel c (e.g., the address of a tty).  Note that the process
+ * PC is rewound st. the system call is re-issued once it is woken: the
+ * call then either completes, or blocks again.
+ */
+
+void block( ctx_t* ctx, void* c ) {
+  executing->status = STATUS_WAITING;
+  executing->wait   = c;
+  ctx->pc          -= 4;
+
+  TRACE( TRACE_WAIT, ( uint32_t )( c ) );
+
+  schedule( ctx );
+  return;
+}
+
+// Make every process blocked on wait channel c ready again
+void wake( void* c ) {
+  for( int i = 0; i < MAX_PROCS; i++ ) {
+    if( procTab[ i ].status == STATUS_WAITING && procTab[ i ].wait == c ) {
+      procTab[ i ].status = STATUS_READY;
+      procTab[ i ].wait   = NULL;
+
+      rq_push( procTab[ i ].cpu, &procTab[ i ] ); // i.e., whichever CPU it last executed on
+
+      TRACE( TRACE_WAKE, procTab[ i ].pid );
+    }
+  }
+  return;
+}
+
+/* Signal each other CPU that should reschedule now rather than at the
+ * next timer tick, i.e., iff. it is idle while some process is ready,
+ * has a process ready which should preempt whatever it is executing,
+ * or is executing a process which has terminated (e.g., been killed).  This
+ * is called before leaving the kernel, st. a handler need not track what
+ * it changed.
+ */
+
+void resched() {
+  for( int c = 0; c < MAX_CPUS; c++ ) {
+    pcb_t* p = cpus[ c ].current;
+
+    if( c == cpu_id() || p == NULL ) {
+      continue;
+    }
+    if( !is_runnable( p ) || rq_preempt( c ) ) {
+      smp_signal( c );
+    }
+  }
+  return;
+}
+
+// Initialise the idle process of this CPU, which has its own stack
+void idle_init() {
+  memset( &idle, 0, sizeof( pcb_t ) );
+  idle.pid                = -1;
+  idle.status             = STATUS_READY;
+  idle.tos                = ( uint32_t )( &tos_idle ) - ( cpu_id() * IDLE_SIZE );
+  idle.ctx.cpsr           = 0x50;
+  idle.ctx.pc             = ( uint32_t )( &main_idle );
+  idle.ctx.sp             = idle.tos;
+}
+
+// -------------------------------------------------------------------------------------------------------------------
+// System calls
+
+/* Arguments are validated before a system call is made, per the kind of
+ * each one in the syscall table, st. a call with any invalid argument
+ * returns -1 rather than, e.g., have the kernel abort while accessing a
+ * bad pointer (which abandons the call and terminates the process, or,
+ * on the light path, cannot be recovered from; see hilevel_handler_seg).
+ * Outside the VM window, memory is mapped 1-to-1 and accessible in USR
+ * mode anyway, so a buffer there is valid iff. it is not NULL and does
+ * not wrap around; within the window, each page must be part of the
+ * address space of the executing process (and writable iff. the kernel
+ * writes to it), and is mapped there and then.
+ */
+
+// Buffer [ x, x + n ) is valid, and writable iff. write
+static bool sys_buf( uint32_t x, uint32_t n, bool write ) {
+  if( n == 0 ) {
+    return true;
+  }
+  if( x == 0 || ( x + n - 1 ) < x ) {
+    return false;
+  }
+  if( ( x + n ) <= VM_BASE || x >= VM_TOP ) {
+    return true;
+  }
+
+  return vm_check( executing->vm, x, n, write );
+}
+
+// String at x is valid, i.e., NUL-terminated within ARGS_SIZE bytes (which is as long as any system call accepts)
+static bool sys_str( uint32_t x ) {
+  for( uint32_t i = 0; i < ARGS_SIZE; i++ ) {
+    if( ( i == 0 || ( ( x + i ) & ( VM_PAGE - 1 ) ) == 0 ) && !sys_buf( x + i, 1, false ) ) { // i.e., check each page once
+      return false;
+    }
+    if( *( char* )( x + i ) == '\0' ) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Array of n buffers at x (per readv or writev) is valid; each buffer is only checked once copied, see iov_copy
+static bool sys_iov( uint32_t x, int n ) {
+  return n >= 0 && n <= MAX_IOV && ( x & 3 ) == 0 && sys_buf( x, n * sizeof( iovec_t ), false );
+}
+
+/* Copy the array of n buffers at x (per readv or writev) into y, st. the
+ * caller only ever uses buffers which have been checked: the array is in
+ * memory the process (or, e.g., another sharing it) can change meanwhile.
+ * Return their total length, or -1 iff. n, the total or any buffer (which
+ * must be writable iff. write) is invalid.
+ */
+
+static int iov_copy( iovec_t* y, const iovec_t* x, int n, bool write ) {
+  if( n < 0 || n > MAX_IOV ) {
+    return -1;
+  }
+
+  uint32_t total = 0;
+
+  for( int i = 0; i < n; i++ ) {
+    y[ i ] = x[ i ];
+
+    if( y[ i ].iov_len > ( INT32_MAX - total ) || !sys_buf( ( uint32_t )( y[ i ].iov_base ), y[ i ].iov_len, write ) ) {
+      return -1;
+    }
+
+    total += y[ i ].iov_len;
+  }
+
+  return total;
+}
+
+// Arguments at x (per spawn) are valid, i.e., NULL or an array of strings, of which spawn reads at most MAX_ARGS before a NULL
+static bool sys_argv( uint32_t x ) {
+  if( x == 0 ) {
+    return true;
+  }
+  if( ( x & 3 ) != 0 ) {
+    return false;
+  }
+
+  for( int i = 0; i <= MAX_ARGS; i++ ) {
+    uint32_t* p = &( ( uint32_t* )( x ) )[ i ];
+
+    if( !sys_buf( ( uint32_t )( p ), sizeof( uint32_t ), false ) ) {
+      return false;
+    }
+    if( *p == 0 || i == MAX_ARGS ) {
+      return true;
+    }
+    if( !sys_str( *p ) ) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Arguments in r0 ... r2 of context ctx are valid per system call s
+static bool sys_check( const syscall_t* s, ctx_t* ctx ) {
+  for( int i = 0; i < SYS_ARGS; i++ ) {
+    uint32_t x = ctx->gpr[ i ], n = ctx->gpr[ i + 1 ]; bool r;
+
+    switch( s->args[ i ] ) {
+      case SYS_ARG_FD      : r = ( int )( x ) >= 0 && ( int )( x ) < MAX_FDS;    break;
+      case SYS_ARG_LEN     : r = ( int )( x ) >= 0;                              break;
+      case SYS_ARG_IN      : r = sys_buf( x, n,       false );                   break;
+      case SYS_ARG_OUT     : r = sys_buf( x, n,       true  );                   break;
+      case SYS_ARG_OBJ_IN  : r = ( x & 3 ) == 0 && sys_buf( x, s->size, false ); break;
+      case SYS_ARG_OBJ_OUT : r = ( x & 3 ) == 0 && sys_buf( x, s->size, true  ); break;
+      case SYS_ARG_STR     : r = sys_str( x );                                   break;
+      case SYS_ARG_IOV_IN  : r = sys_iov( x, n );                                break;
+      case SYS_ARG_IOV_OUT : r = sys_iov( x, n );                                break;
+      case SYS_ARG_ARGV    : r = sys_argv( x );                                  break;
+      default              : r = true;                                           break;
+    }
+
+    if( !r ) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Each system call is made by a handler which reads the arguments from,
+ * and writes any return value back to, preserved USR mode registers; the
+ * result is a wait channel iff. the call cannot complete yet (e.g., a
+ * read from an empty tty), in which case the caller blocks on it and the
+ * call is re-issued once woken.  Note that a call returning a wait channel
+ * must not have changed anything, st. doing so is safe.
+ */
+
+// 0x00 => yield()
+static void* sys_yield( ctx_t* ctx ) {
+#if defined( CONFIG_DEBUG )
+  PL011_putc( UART0, '[', true );
+  PL011_putc( UART0, 'Y', true );
+  PL011_putc( UART0, ']', true );
+#endif
+
+  schedule( ctx );
+
+  return NULL;
+}
+
+// 0x01 => write( fd, x, n )
+static void* sys_write( ctx_t* ctx ) {
+  int   fd = ( int   )( ctx->gpr[ 0 ] );
+  char*  x = ( char* )( ctx->gpr[ 1 ] );
+  int    n = ( int   )( ctx->gpr[ 2 ] );
+
+  file_t* f = get_file( fd );
+  if( f == NULL || f->ops->write == NULL ) {
+    ctx->gpr[ 0 ] = -1;
+    return NULL;
+  }
+
+  // Write; if the file can't accept anything yet (e.g., a full tty), wait for it
+  int r = f->ops->write( f, ( uint8_t* )( x ), n );
+  if( r == FILE_AGAIN ) {
+    return f->data;
+  }
+
+  // Set return values
+  ctx->gpr[ 0 ] = r;
+
+  return NULL;
+}
+
+// 0x02 => read( fd, x, n )
+static void* sys_read( ctx_t* ctx ) {
+  int   fd = ( int   )( ctx->gpr[ 0 ] );
+  char*  x = ( char* )( ctx->gpr[ 1 ] );
+  int    n = ( int   )( ctx->gpr[ 2 ] );
+
+  file_t* f = get_file( fd );
+  if( f == NULL || f->ops->read == NULL ) {
+    ctx->gpr[ 0 ] = -1;
+    return NULL;
+  }
+
+  // Read; if the file has nothing yet (e.g., an empty tty), wait for it
+  int r = f->ops->read( f, ( uint8_t* )( x ), n );
+  if( r == FILE_AGAIN ) {
+    return f->data;
+  }
+
+  // Set return values
+  ctx->gpr[ 0 ] = r;
+
+  return NULL;
+}
+
+// 0x03 => fork()
+static void* sys_fork( ctx_t* ctx ) {
+#if defined( CONFIG_DEBUG )
+  PL011_putc( UART0, '[', true );
+  PL011_putc( UART0, 'F', true );
+  PL011_putc( UART0, ']', true );
+#endif
+
+  // Get PCB
+  int idx = get_free_pcb_index();
+  if( idx == -1 ) { // If there's no free PCB left, return
+    ctx->gpr[0] = -1;
+    return NULL;
+  }
+  pcb_t* child_pcb = &procTab[ idx ];
+
+  // Copy address space (iff. any); if there's no room left, return
+  vm_t* vm = NULL;
+  if( executing->vm != NULL && ( vm = vm_fork( executing->vm ) ) == NULL ) {
+    ctx->gpr[0] = -1;
+    return NULL;
+  }
+
+  child_pcb->tos   = ( uint32_t )( &tos_procs ) - (idx * PROC_SIZE);
+
+  // Copy context from parent PCB to child PCB, including VFP/NEON registers
+  ctx_copy( &child_pcb->ctx, ctx );
+  fpu_copy( executing, child_pcb );
+
+  // Copy stack (including TLS) from parent PCB to child PCB
+  // mem_copy() works from the bottom up
+  uint32_t parent_stack = executing->tos - PROC_SIZE;
+  uint32_t child_stack  = child_pcb->tos - PROC_SIZE;
+  mem_copy( ( void* ) child_stack, ( void* ) parent_stack, PROC_SIZE );
+
+  // Calculate offset for the sp of child PCB
+  uint32_t offset = (uint32_t)( executing->tos - ctx->sp );
+
+  // Create PCB and set the attributes
+  child_pcb->pid        = idx;
+  child_pcb->status     = STATUS_CREATED;
+  child_pcb->tls        = child_pcb->tos - PROC_TLS;
+  child_pcb->ctx.sp     = ( vm == NULL ) ? child_pcb->tos - offset : ctx->sp; // an image stack is in the window
+  child_pcb->b_priority = 1;
+  child_pcb->age        = 0;
+  child_pcb->vm         = vm;
+  child_pcb->policy     = ( executing->policy != SCHED_EDF ) ? executing->policy : SCHED_FAIR; // SCHED_EDF needs admission
+  child_pcb->vruntime   = executing->vruntime;
+  child_pcb->slice      = executing->slice;
+
+  // Share open files with child
+  for( int i = 0; i < MAX_FDS; i++ ) {
+    child_pcb->fd[ i ] = get_process( executing )->fd[ i ];
+    if( child_pcb->fd[ i ] != NULL ) file_dup( child_pcb->fd[ i ] );
+  }
+
+  // Set return values
+  ctx->gpr[0]           = child_pcb->pid; // Return value for parent
+  child_pcb->ctx.gpr[0] = 0;              // Return value for child
+
+  rq_push( rq_place( cpu_id() ), child_pcb );
+
+  TRACE( TRACE_FORK, child_pcb->pid );
+
+  return NULL;
+}
+
+// 0x04 => exit( status )
+static void* sys_exit( ctx_t* ctx ) {
+#if defined( CONFIG_DEBUG )
+  PL011_putc( UART0, '[', true );
+  PL011_putc( UART0, 'E', true );
+  PL011_putc( UART0, 'X', true );
+  PL011_putc( UART0, 'I', true );
+  PL011_putc( UART0, 'T', true );
+  PL011_putc( UART0, ']', true );
+#endif
+
+  // Close files, reset contents of PCB, indicate termination (of each thread too, iff. a process) and re-schedule
+  terminate( executing );
+  schedule( ctx );
+
+  return NULL;
+}
+
+// 0x05 => exec( x )
+static void* sys_exec( ctx_t* ctx ) {
+#if defined( CONFIG_DEBUG )
+  PL011_putc( UART0, '[', true );
+  PL011_putc( UART0, 'E', true );
+  PL011_putc( UART0, 'X', true );
+  PL011_putc( UART0, 'E', true );
+  PL011_putc( UART0, 'C', true );
+  PL011_putc( UART0, ']', true );
+#endif
+
+  char* x = ( char* )( ctx->gpr[ 0 ] );
+
+  // Find the program named x; if there's no such program or no room for it, return
+  uint32_t entry; int priority; vm_t* vm;
+  if( !get_program( x, &entry, &priority, &vm ) ) {
+    ctx->gpr[ 0 ] = -1;
+    return NULL;
+  }
+
+  // Replace address space (iff. any); pages of an image are then mapped as the process touches them
+  if( executing->vm != NULL ) vm_free( executing->vm );
+  executing->vm = vm;
+  vm_switch( vm );
+
+  // Set attributes, and start afresh with an empty stack (at the top of the window iff. an image) and TLS
+  ctx->pc               = entry;
+  ctx->sp               = ( vm != NULL ) ? VM_TOP : executing->tls;
+  executing->b_priority = priority;
+  mem_zero( ( void* )( executing->tls ), PROC_TLS );
+
+  return NULL;
+}
+
+// 0x06 => kill( pid, x )
+static void* sys_kill( ctx_t* ctx ) {
+#if defined( CONFIG_DEBUG )
+  PL011_putc( UART0, '[', true );
+  PL011_putc( UART0, 'K', true );
+  PL011_putc( UART0, ']', true );
+#endif
+
+  pid_t pid = ( pid_t )( ctx->gpr[ 0 ] );
+
+  // Get the PCB, close its files, reset it and indicate termination
+  pcb_t* target = get_pcb( pid );
+  if( target != NULL ) {
+    bool self = ( target == executing || target == get_process( executing ) ); // i.e., before terminate resets either
+
+    terminate( target );
+
+    // If the executing process (or thread) was terminated, it must not be returned to, exactly as per exit
+    if( self ) {
+      schedule( ctx );
+    }
+  }
+
+  return NULL;
+}
+
+// 0x07 => nice( pid, x )
+static void* sys_nice( ctx_t* ctx ) {
+#if defined( CONFIG_DEBUG )
+  PL011_putc( UART0, '[', true );
+  PL011_putc( UART0, 'P', true );
+  PL011_putc( UART0, ']', true );
+#endif
+
+  pid_t pid = ( pid_t )( ctx->gpr[ 0 ] );
+  int     x = (int    )( ctx->gpr[ 1 ] );
+
+  // Get the PCB and set base priority to x
+  pcb_t* target = get_pcb( pid );
+  if( target != NULL ) target->b_priority = x;
+
+  return NULL;
+}
+
+// 0x08 => shm_open( uint32_t size )
+static void* sys_shm_open( ctx_t* ctx ) {
+  uint32_t size = ( uint32_t )( ctx->gpr[ 0 ] );
+
+  // Find free file descriptor and unoccupied region
+  int     fd = get_free_fd();
+  file_t*  f = ( fd != -1 ) ? shm_file( size ) : NULL;
+  if( f == NULL ) { // If there's no free fd or shm left, return
+    ctx->gpr[0] = -1;
+    return NULL;
+  }
+
+  // Return fd
+  get_process( executing )->fd[ fd ] = f;
+  ctx->gpr[0] = fd;
+  return NULL;
+}
+
+// 0x09 => mmap( int fd )
+static void* sys_mmap( ctx_t* ctx ) {
+  int fd = ( int )( ctx->gpr[ 0 ] );
+
+  // Return a pointer to the file (e.g., shm region) iff. it can be mapped
+  file_t* f = get_file( fd );
+  if( f == NULL || f->ops->mmap == NULL ) {
+    ctx->gpr[0] = 0;
+    return NULL;
+  }
+
+  ctx->gpr[0] = ( uint32_t )( f->ops->mmap( f ) );
+
+  return NULL;
+}
+
+// 0x0A => shm_unlink( int fd )
+static void* sys_shm_unlink( ctx_t* ctx ) {
+  int fd = ( int )( ctx->gpr[ 0 ] );
+
+  // Reset contents of shm region
+  file_t* f = get_file( fd );
+  if( f != NULL && f->type == FILE_SHM ) {
+    region* r = ( region* )( f->data );
+    mem_zero( ( void* )( r->offset ), r->size );
+  }
+
+  return NULL;
+}
+
+// 0x0B => writev( fd, iov, n )
+static void* sys_writev( ctx_t* ctx ) {
+  int       fd = ( int       )( ctx->gpr[ 0 ] );
+  iovec_t* iov = ( iovec_t*  )( ctx->gpr[ 1 ] );
+  int        n = ( int       )( ctx->gpr[ 2 ] );
+
+  file_t* f = get_file( fd );
+  iovec_t v[ MAX_IOV ]; int total = iov_copy( v, iov, n, false ), r = 0;
+  if( f == NULL || f->ops->write == NULL || total < 0 ) {
+    ctx->gpr[ 0 ] = -1;
+    return NULL;
+  }
+
+  if( total <= IOV_ATOMIC ) {
+    // Gather buffers, st. they are written as one atomic write
+    uint8_t t[ IOV_ATOMIC ]; int k = 0;
+    for( int i = 0; i < n; i++ ) {
+      memcpy( &t[ k ], v[ i ].iov_base, v[ i ].iov_len ); k += v[ i ].iov_len;
+    }
+
+    r = f->ops->write( f, t, total );
+  }
+  else {
+    // Too large to be atomic: write buffer by buffer, stopping at the first that isn't written in full
+    for( int i = 0; i < n; i++ ) {
+      int k = f->ops->write( f, ( uint8_t* )( v[ i ].iov_base ), v[ i ].iov_len );
+      if( k < 0 ) {
+        r = ( r > 0 ) ? r : k;
+        break;
+      }
+      r += k;
+      if( k < v[ i ].iov_len ) break;
+    }
+  }
+
+  // If the file can't accept anything yet, wait for it
+  if( r == FILE_AGAIN ) {
+    return f->data;
+  }
+
+  // Set return values
+  ctx->gpr[ 0 ] = r;
+
+  return NULL;
+}
+
+// 0x0C => readv( fd, iov, n )
+static void* sys_readv( ctx_t* ctx ) {
+  int       fd = ( int       )( ctx->gpr[ 0 ] );
+  iovec_t* iov = ( iovec_t*  )( ctx->gpr[ 1 ] );
+  int        n = ( int       )( ctx->gpr[ 2 ] );
+
+  file_t* f = get_file( fd );
+  iovec_t v[ MAX_IOV ]; int total = iov_copy( v, iov, n, true ), r = 0;
+  if( f == NULL || f->ops->read == NULL || total < 0 ) {
+    ctx->gpr[ 0 ] = -1;
+    return NULL;
+  }
+
+  // Scatter into each buffer in turn, stopping at the first that isn't filled
+  for( int i = 0; i < n; i++ ) {
+    int k = f->ops->read( f, ( uint8_t* )( v[ i ].iov_base ), v[ i ].iov_len );
+    if( k < 0 ) {
+      r = ( r > 0 ) ? r : k;
+      break;
+    }
+    r += k;
+    if( k < v[ i ].iov_len ) break;
+  }
+
+  // If the file has nothing yet, wait for it
+  if( r == FILE_AGAIN ) {
+    return f->data;
+  }
+
+  // Set return values
+  ctx->gpr[ 0 ] = r;
+
+  return NULL;
+}
+
+// 0x0D => open( x )
+static void* sys_open( ctx_t* ctx ) {
+  char* x = ( char* )( ctx->gpr[ 0 ] );
+
+  // Find free file descriptor and open the named device
+  int     fd = get_free_fd();
+  file_t*  f = ( fd != -1 ) ? file_open( x ) : NULL;
+  if( f == NULL ) {
+    ctx->gpr[ 0 ] = -1;
+    return NULL;
+  }
+
+  // Return fd
+  get_process( executing )->fd[ fd ] = f;
+  ctx->gpr[ 0 ] = fd;
+
+  return NULL;
+}
+
+// 0x0E => close( fd )
+static void* sys_close( ctx_t* ctx ) {
+  int fd = ( int )( ctx->gpr[ 0 ] );
+
+  file_t* f = get_file( fd );
+  if( f == NULL ) {
+    ctx->gpr[ 0 ] = -1;
+    return NULL;
+  }
+
+  // Release file descriptor, and file iff. it was the last reference
+  file_close( f );
+  get_process( executing )->fd[ fd ] = NULL;
+  ctx->gpr[ 0 ] = 0;
+
+  return NULL;
+}
+
+// 0x0F => lseek( fd, offset, whence )
+static void* sys_lseek( ctx_t* ctx ) {
+  int       fd = ( int )( ctx->gpr[ 0 ] );
+  int   offset = ( int )( ctx->gpr[ 1 ] );
+  int   whence = ( int )( ctx->gpr[ 2 ] );
+
+  // Only disk files are seekable
+  file_t* f = get_file( fd );
+  if( f == NULL || f->type != FILE_DISK ) {
+    ctx->gpr[ 0 ] = -1;
+    return NULL;
+  }
+
+  if     ( whence == SEEK_SET ) f->offset  = offset;
+  else if( whence == SEEK_CUR ) f->offset += offset;
+
+  // Return new offset
+  ctx->gpr[ 0 ] = f->offset;
+
+  return NULL;
+}
+
+// 0x10 => pipe( fd )
+static void* sys_pipe( ctx_t* ctx ) {
+  int* fd = ( int* )( ctx->gpr[ 0 ] );
+
+  // Find two free file descriptors
+  int r = -1, w = -1;
+  for( int i = 0; i < MAX_FDS && w == -1; i++ ) {
+    if( get_process( executing )->fd[ i ] == NULL ) {
+      if( r == -1 ) r = i; else w = i;
+    }
+  }
+
+  file_t *fr, *fw;
+  if( w == -1 || !pipe_open( &fr, &fw ) ) {
+    ctx->gpr[ 0 ] = -1;
+    return NULL;
+  }
+
+  // Return fds, i.e., read end in fd[ 0 ] and write end in fd[ 1 ]
+  get_process( executing )->fd[ r ] = fr; fd[ 0 ] = r;
+  get_process( executing )->fd[ w ] = fw; fd[ 1 ] = w;
+  ctx->gpr[ 0 ] = 0;
+
+  return NULL;
+}
+
+// 0x11 => dup2( old, new )
+static void* sys_dup2( ctx_t* ctx ) {
+  int old = ( int )( ctx->gpr[ 0 ] );
+  int new = ( int )( ctx->gpr[ 1 ] );
+
+  file_t* f = get_file( old );
+  if( f == NULL || new < 0 || new >= MAX_FDS ) {
+    ctx->gpr[ 0 ] = -1;
+    return NULL;
+  }
+
+  // Make new refer to the same file as old, closing whatever it referred to before
+  if( new != old ) {
+    file_dup( f );
+    if( get_process( executing )->fd[ new ] != NULL ) file_close( get_process( executing )->fd[ new ] );
+    get_process( executing )->fd[ new ] = f;
+  }
+
+  // Return new fd
+  ctx->gpr[ 0 ] = new;
+
+  return NULL;
+}
+
+// 0x12 => spawn( x, priority, argv )
+static void* sys_spawn( ctx_t* ctx ) {
+#if defined( CONFIG_DEBUG )
+  PL011_putc( UART0, '[', true );
+  PL011_putc( UART0, 'S', true );
+  PL011_putc( UART0, 'P', true );
+  PL011_putc( UART0, ']', true );
+#endif
+
+  char*  x        = ( char*  )( ctx->gpr[ 0 ] );
+  int    priority = ( int    )( ctx->gpr[ 1 ] );
+  char** argv     = ( char** )( ctx->gpr[ 2 ] );
+
+  /* Measure the arguments: the block copied onto the child stack holds
+   * the strings, then (8-byte aligned, below them) a NULL-terminated
+   * array of pointers to each one.
+   */
+
+  int argc = 0, size = 0;
+  for( ; argv != NULL && argv[ argc ] != NULL && argc < MAX_ARGS; argc++ ) {
+    size += strlen( argv[ argc ] ) + 1;
+  }
+  uint32_t strs = size, ptrs = ( ( size + 7 ) & ~7 ) + ( ( argc + 2 ) & ~1 ) * sizeof( char* );
+
+  // Get PCB and program; if there's no free PCB, no such program or no room for it, return
+  int idx = get_free_pcb_index(); uint32_t entry; int b_priority; vm_t* vm;
+  if( idx == -1 || ( argv != NULL && argv[ argc ] != NULL ) || ptrs > ARGS_SIZE || !get_program( x, &entry, &b_priority, &vm ) ) {
+    ctx->gpr[ 0 ] = -1;
+    return NULL;
+  }
+  pcb_t* child_pcb = &procTab[ idx ];
+
+  // Create PCB at the entry point, rather than copy the parent
+  mem_zero( child_pcb, sizeof( pcb_t ) );
+  child_pcb->pid        = idx;
+  child_pcb->status     = STATUS_CREATED;
+  child_pcb->tos        = ( uint32_t )( &tos_procs ) - ( idx * PROC_SIZE );
+  child_pcb->tls        = child_pcb->tos - PROC_TLS;
+  child_pcb->ctx.cpsr   = 0x50;
+  child_pcb->ctx.pc     = entry;
+  child_pcb->b_priority = ( priority >= 0 ) ? priority : b_priority;
+  child_pcb->age        = 0;
+  child_pcb->vm         = vm;
+  mem_zero( ( void* )( child_pcb->tls ), PROC_TLS );
+
+  // Copy arguments below TLS, st. the child is entered with r0 = argc and r1 = argv
+  char*  s = ( char*  )( child_pcb->tls - strs );
+  char** p = ( char** )( child_pcb->tls - ptrs );
+  for( int i = 0; i < argc; i++ ) {
+    int n = strlen( argv[ i ] ) + 1;
+    memcpy( s, argv[ i ], n ); p[ i ] = s; s += n;
+  }
+  p[ argc ] = NULL;
+
+  child_pcb->ctx.gpr[ 0 ] = argc;
+  child_pcb->ctx.gpr[ 1 ] = ( uint32_t )( p );
+  child_pcb->ctx.sp       = ( vm != NULL ) ? VM_TOP : ( uint32_t )( p ); // an image stack is in the window
+
+  // Share standard files with child, but no others (e.g., the read end of a pipe the child writes, per a console pipeline)
+  for( int i = 0; i <= STDERR_FILENO; i++ ) {
+    child_pcb->fd[ i ] = get_process( executing )->fd[ i ];
+    if( child_pcb->fd[ i ] != NULL ) file_dup( child_pcb->fd[ i ] );
+  }
+
+  rq_push( rq_place( cpu_id() ), child_pcb );
+
+  TRACE( TRACE_FORK, child_pcb->pid );
 
-// -------------------------------------------------------------------------------------------------------------------
-// Getters
+  // Return child PID
+  ctx->gpr[ 0 ] = child_pcb->pid;
 
-pcb_t* get_pcb ( pid_t pid ) {
-  for( int i = 0; i < MAX_PROCS; i++ ) {
-    if( procTab[i].pid == pid ) return &procTab[i];
+  return NULL;
+}
+
+// 0x13 => thread_create( entry, x, y )
+static void* sys_thread_create( ctx_t* ctx ) {
+#if defined( CONFIG_DEBUG )
+  PL011_putc( UART0, '[', true );
+  PL011_putc( UART0, 'T', true );
+  PL011_putc( UART0, 'C', true );
+  PL011_putc( UART0, ']', true );
+#endif
+
+  uint32_t entry = ( uint32_t )( ctx->gpr[ 0 ] );
+
+  // Get PCB
+  int idx = get_free_pcb_index();
+  if( idx == -1 ) { // If there's no free PCB left, return
+    ctx->gpr[ 0 ] = -1;
+    return NULL;
   }
+  pcb_t* thread = &procTab[ idx ];
+
+  // Create PCB at the entry point, with its own stack and TLS but in the same group, i.e., process
+  mem_zero( thread, sizeof( pcb_t ) );
+  thread->pid          = idx;
+  thread->status       = STATUS_CREATED;
+  thread->tos          = ( uint32_t )( &tos_procs ) - ( idx * PROC_SIZE );
+  thread->tls          = thread->tos - PROC_TLS;
+  thread->ctx.cpsr     = 0x50;
+  thread->ctx.pc       = entry;
+  thread->ctx.gpr[ 0 ] = ctx->gpr[ 1 ];
+  thread->ctx.gpr[ 1 ] = ctx->gpr[ 2 ];
+  thread->ctx.sp       = thread->tls;
+  thread->b_priority   = executing->b_priority;
+  thread->age          = 0;
+  thread->policy       = ( executing->policy != SCHED_EDF ) ? executing->policy : SCHED_FAIR; // SCHED_EDF needs admission
+  thread->vruntime     = executing->vruntime;
+  thread->slice        = executing->slice;
+  thread->group        = get_process( executing );
+  mem_zero( ( void* )( thread->tls ), PROC_TLS );
+
+  // Share address space (iff. any)
+  if( ( thread->vm = executing->vm ) != NULL ) vm_dup( thread->vm );
+
+  rq_push( rq_place( cpu_id() ), thread );
+
+  TRACE( TRACE_FORK, thread->pid );
+
+  // Return thread ID
+  ctx->gpr[ 0 ] = thread->pid;
+
   return NULL;
 }
 
-int get_free_region_index() {
-  for( int i = 0; i < MAX_SHM; i++ ) {
-    if( regions[ i ].state == UNOCCUPIED ) return i;
+// 0x14 => thread_join( t )
+static void* sys_thread_join( ctx_t* ctx ) {
+  pid_t t = ( pid_t )( ctx->gpr[ 0 ] );
+
+  // Wait iff. t is a (live) thread of the same process; it wakes us once terminated
+  pcb_t* thread = ( t >= 0 && t < MAX_PROCS ) ? &procTab[ t ] : NULL;
+  if( thread != NULL && thread != executing && thread->pid == t &&
+      thread->group == get_process( executing ) && thread->status != STATUS_TERMINATED ) {
+    return thread;
   }
 
-  return -1; // If no free PCB
-} 
+  ctx->gpr[ 0 ] = 0;
 
-// Get the next free PCB in process table
-int get_free_pcb_index() {
-  for( int i = 0; i < MAX_PROCS; i++ ) {
-    if( procTab[ i ].status == STATUS_INVALID || procTab[ i ].status == STATUS_TERMINATED ) return i;
+  return NULL;
+}
+
+// 0x15 => sched_setclass( pid, x )
+static void* sys_sched_setclass( ctx_t* ctx ) {
+  pid_t pid = ( pid_t )( ctx->gpr[ 0 ] );
+  int     x = ( int   )( ctx->gpr[ 1 ] );
+
+  // Get the PCB and move it into scheduling class x
+  pcb_t* target = get_pcb( pid );
+  if( target == NULL || ( !is_runnable( target ) && target->status != STATUS_WAITING ) || !sched_class( target, x ) ) {
+    ctx->gpr[ 0 ] = -1;
+    return NULL;
   }
 
-  return -1; // If no free PCB
+  ctx->gpr[ 0 ] = 0;
+
+  return NULL;
 }
 
-// -------------------------------------------------------------------------------------------------------------------
-// Scheduling
+// 0x16 => sched_setattr( pid, x )
+static void* sys_sched_setattr( ctx_t* ctx ) {
+  pid_t          pid = ( pid_t         )( ctx->gpr[ 0 ] );
+  sched_attr_t*    x = ( sched_attr_t* )( ctx->gpr[ 1 ] );
 
-void dispatch( ctx_t* ctx, pcb_t* prev, pcb_t* next ) {
-  char prev_pid = '?', next_pid = '?';
+  // Get the PCB and move it into the scheduling class (with parameters) per x, iff. it can be admitted
+  pcb_t* target = get_pcb( pid );
+  if( target == NULL || ( !is_runnable( target ) && target->status != STATUS_WAITING ) || !sched_admit( target, x ) ) {
+    ctx->gpr[ 0 ] = -1;
+    return NULL;
+  }
 
-  if( NULL != prev ) {
-    memcpy( &prev->ctx, ctx, sizeof( ctx_t ) ); // preserve execution context of P_{prev}
-    prev_pid = '0' + prev->pid;
+  ctx->gpr[ 0 ] = 0;
+
+  return NULL;
+}
+
+// 0x17 => sched_setslice( pid, x )
+static void* sys_sched_setslice( ctx_t* ctx ) {
+  pid_t    pid = ( pid_t    )( ctx->gpr[ 0 ] );
+  uint32_t   x = ( uint32_t )( ctx->gpr[ 1 ] );
+
+  // Get the PCB and set its time slice, which takes effect once next dispatched
+  pcb_t* target = get_pcb( pid );
+  if( target == NULL || ( !is_runnable( target ) && target->status != STATUS_WAITING ) || !sched_slice( target, x ) ) {
+    ctx->gpr[ 0 ] = -1;
+    return NULL;
   }
-  if( NULL != next ) {
-    memcpy( ctx, &next->ctx, sizeof( ctx_t ) ); // restore  execution context of P_{next}
-    next_pid = '0' + next->pid;
+
+  ctx->gpr[ 0 ] = 0;
+
+  return NULL;
+}
+
+// 0x18 => sched_setquantum( c, x )
+static void* sys_sched_setquantum( ctx_t* ctx ) {
+  int        c = ( int      )( ctx->gpr[ 0 ] );
+  uint32_t   x = ( uint32_t )( ctx->gpr[ 1 ] );
+
+  ctx->gpr[ 0 ] = sched_quantum( c, x ) ? 0 : -1;
+
+  return NULL;
+}
+
+// 0x19 => getstats( pid, x )
+static void* sys_getstats( ctx_t* ctx ) {
+  pid_t          pid = ( pid_t    )( ctx->gpr[ 0 ] );
+  stats_t*         x = ( stats_t* )( ctx->gpr[ 1 ] );
+
+  // Get the PCB, or else (iff. pid = -1 - c) the idle process of CPU c, and copy its accounting
+  pcb_t* target = ( pid >= 0 ) ? get_pcb( pid ) : ( pid >= -MAX_CPUS && cpus[ -1 - pid ].current != NULL ) ? &cpus[ -1 - pid ].idle_pcb : NULL;
+  if( target == NULL || target->status == STATUS_INVALID || target->status == STATUS_TERMINATED ) {
+    ctx->gpr[ 0 ] = -1;
+    return NULL;
   }
 
-  PL011_putc( UART0, '[',      true );
-  PL011_putc( UART0, prev_pid, true );
-  PL011_putc( UART0, '-',      true );
-  PL011_putc( UART0, '>',      true );
-  PL011_putc( UART0, next_pid, true );
-  PL011_putc( UART0, ']',      true );
-  PL011_putc( UART0, '\n',     true );
+  memcpy( x, &target->stats, sizeof( stats_t ) );
 
-  executing = next;                             // update   executing process to P_{next}
+  ctx->gpr[ 0 ] = 0;
 
-  return;
+  return NULL;
 }
 
-// Using priority+age-based scheduling
-void schedule( ctx_t* ctx ) {
-  pcb_t* next;
-  int priority;
-  int max_priority = 0;
+// 0x1A => cycles()
+static void* sys_cycles( ctx_t* ctx ) {
+  // Read the PMU cycle counter on behalf of the process, which cannot access the PMU itself (st. it cannot reset or reconfigure the counters accounting relies on)
+  ctx->gpr[ 0 ] = pmu_cycles();
 
-  // Find process with highest priority and assign it as next process
-  for( int i = 0; i < MAX_PROCS; i++ ) {
-    if( procTab[ i ].status != STATUS_INVALID && procTab[ i ].status != STATUS_TERMINATED ) {
-      priority = procTab[i].b_priority + procTab[i].age; // base priority + age
+  return NULL;
+}
 
-      if( max_priority <= priority ) {
-        next = &procTab[ i ];
-        max_priority = priority;
-      }
+// 0x1B => trace( x )
+static void* sys_trace( ctx_t* ctx ) {
+  int x = ( int )( ctx->gpr[ 0 ] );
+
+  ctx->gpr[ 0 ] = trace_ctl( x ) ? 0 : -1;
+
+  return NULL;
+}
+
+// 0x1C => prof( x, y )
+static void* sys_prof( ctx_t* ctx ) {
+  int      x = ( int      )( ctx->gpr[ 0 ] );
+  uint32_t y = ( uint32_t )( ctx->gpr[ 1 ] );
+
+  ctx->gpr[ 0 ] = prof_ctl( x, y ) ? 0 : -1;
+
+  return NULL;
+}
+
+// 0x1D => getpid()
+static void* sys_getpid( ctx_t* ctx ) {
+  // Return PID of the process, i.e., of the group iff. a thread
+  ctx->gpr[ 0 ] = get_process( executing )->pid;
+
+  return NULL;
+}
+
+/* The syscall table is indexed by the identifier (i.e., the immediate
+ * operand) of the svc instruction.  A light call is one which never
+ * reschedules (e.g., via yield or exit), nor creates or destroys a
+ * process, nor uses any part of the context other than r0 ... r2: it can
+ * be made via the light path (see hilevel_handler_svc_light), whether or
+ * not it then has to block.
+ */
+
+static const syscall_t syscalls[] = {
+  [ 0x00 ] = { sys_yield,            false, { SYS_ARG_ANY,     SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x01 ] = { sys_write,            true,  { SYS_ARG_FD,      SYS_ARG_IN,      SYS_ARG_LEN  }                          },
+  [ 0x02 ] = { sys_read,             true,  { SYS_ARG_FD,      SYS_ARG_OUT,     SYS_ARG_LEN  }                          },
+  [ 0x03 ] = { sys_fork,             false, { SYS_ARG_ANY,     SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x04 ] = { sys_exit,             false, { SYS_ARG_ANY,     SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x05 ] = { sys_exec,             false, { SYS_ARG_STR,     SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x06 ] = { sys_kill,             false, { SYS_ARG_ANY,     SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x07 ] = { sys_nice,             true,  { SYS_ARG_ANY,     SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x08 ] = { sys_shm_open,         true,  { SYS_ARG_ANY,     SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x09 ] = { sys_mmap,             true,  { SYS_ARG_ANY,     SYS_ARG_ANY,     SYS_ARG_ANY  }                          }, // i.e., get_file checks fd, since the result is NULL (vs. -1) iff. invalid
+  [ 0x0A ] = { sys_shm_unlink,       true,  { SYS_ARG_FD,      SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x0B ] = { sys_writev,           true,  { SYS_ARG_FD,      SYS_ARG_IOV_IN,  SYS_ARG_LEN  }                          },
+  [ 0x0C ] = { sys_readv,            true,  { SYS_ARG_FD,      SYS_ARG_IOV_OUT, SYS_ARG_LEN  }                          },
+  [ 0x0D ] = { sys_open,             true,  { SYS_ARG_STR,     SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x0E ] = { sys_close,            true,  { SYS_ARG_FD,      SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x0F ] = { sys_lseek,            true,  { SYS_ARG_FD,      SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x10 ] = { sys_pipe,             true,  { SYS_ARG_OBJ_OUT, SYS_ARG_ANY,     SYS_ARG_ANY  }, 2 * sizeof( int )       },
+  [ 0x11 ] = { sys_dup2,             true,  { SYS_ARG_FD,      SYS_ARG_FD,      SYS_ARG_ANY  }                          },
+  [ 0x12 ] = { sys_spawn,            false, { SYS_ARG_STR,     SYS_ARG_ANY,     SYS_ARG_ARGV }                          },
+  [ 0x13 ] = { sys_thread_create,    false, { SYS_ARG_ANY,     SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x14 ] = { sys_thread_join,      true,  { SYS_ARG_ANY,     SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x15 ] = { sys_sched_setclass,   true,  { SYS_ARG_ANY,     SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x16 ] = { sys_sched_setattr,    true,  { SYS_ARG_ANY,     SYS_ARG_OBJ_IN,  SYS_ARG_ANY  }, sizeof( sched_attr_t )  },
+  [ 0x17 ] = { sys_sched_setslice,   true,  { SYS_ARG_ANY,     SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x18 ] = { sys_sched_setquantum, true,  { SYS_ARG_ANY,     SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x19 ] = { sys_getstats,         true,  { SYS_ARG_ANY,     SYS_ARG_OBJ_OUT, SYS_ARG_ANY  }, sizeof( stats_t )       },
+  [ 0x1A ] = { sys_cycles,           true,  { SYS_ARG_ANY,     SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x1B ] = { sys_trace,            true,  { SYS_ARG_ANY,     SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x1C ] = { sys_prof,             true,  { SYS_ARG_ANY,     SYS_ARG_ANY,     SYS_ARG_ANY  }                          },
+  [ 0x1D ] = { sys_getpid,           true,  { SYS_ARG_ANY,     SYS_ARG_ANY,     SYS_ARG_ANY  }                          }
+};
+
+#define SYSCALLS ( sizeof( syscalls ) / sizeof( syscall_t ) )
+
+// -------------------------------------------------------------------------------------------------------------------
+// Interrupts
+
+/* The top and bottom half of each interrupt (see irq.h): each top half
+ * only touches its device, or the profiler, whereas each bottom half
+ * executes with the kernel lock held (on behalf of the outermost handler,
+ * st. ctx is the USR mode context it preserved).
+ */
+
+// The periodic timer only rebalances, since the one-shot timer ends each time slice (which resched then signals idle CPUs about)
+static bool irq_timer0( ctx_t* ctx, void* data ) {
+  TIMER0->Timer1IntClr = 0x01;
+
+  return true;
+}
+
+static void irq_timer0_bh( ctx_t* ctx, void* data ) {
+  rq_balance();
+}
+
+// The profiling timer shares the source with the one-shot timer, so either (or both) may have expired
+static bool irq_timer1( ctx_t* ctx, void* data ) {
+  bool r = false;
+
+  // The profiling timer expired, so sample this CPU then signal every other
+  if( TIMER1->Timer2MIS & 0x01 ) {
+    TIMER1->Timer2IntClr = 0x01;
+
+    prof_sample( ( executing != NULL ) ? executing->pid : -1, ctx->pc, ctx->lr, ctx->cpsr );
+
+    if( MAX_CPUS > 1 ) {
+      smp_broadcast( SGI_PROFILE );
     }
   }
 
-  // Increment age of other processes in the ready queue
-  for( int i = 0; i < MAX_PROCS; i++ ) {
-    if( procTab[ i ].status != STATUS_INVALID && procTab[ i ].status != STATUS_TERMINATED ) {
-      if( next->pid != procTab[i].pid ) procTab[i].age++;
-      else procTab[i].age = 0;
-    }
+  // The one-shot timer expired, i.e., the time slice of some process ended, or some process in SCHED_EDF had its budget replenished
+  if( TIMER1->Timer1MIS & 0x01 ) {
+    TIMER1->Timer1IntClr = 0x01; r = true;
   }
 
-  // Switch context
-  dispatch( ctx, executing, next );
-  executing->status = STATUS_READY;
-  next->status = STATUS_EXECUTING;
-  return;
+  return r;
+}
+
+static void irq_timer1_bh( ctx_t* ctx, void* data ) {
+  if( rq_expired( cpu_id() ) ) {
+#if defined( CONFIG_DEBUG )
+    PL011_putc( UART0, '[', true );
+    PL011_putc( UART0, 'T', true );
+    PL011_putc( UART0, ']', true );
+#endif
+
+    schedule( ctx );
+  }
+}
+
+static bool irq_profile( ctx_t* ctx, void* data ) {
+  prof_sample( ( executing != NULL ) ? executing->pid : -1, ctx->pc, ctx->lr, ctx->cpsr );
+
+  return false;
+}
+
+static void irq_resched_bh( ctx_t* ctx, void* data ) {
+  schedule( ctx );
+}
+
+// A tty has no top half, so the UART is masked until the bottom half has moved bytes between FIFO and rings
+static void irq_tty_bh( ctx_t* ctx, void* data ) {
+  tty_handler_irq( ( tty_t* )( data ) );
+  wake( data );
+}
+
+// Nor does the dump UART, which is masked until the bottom half has refilled the FIFO
+static void irq_dump_bh( ctx_t* ctx, void* data ) {
+  dump_handler_irq();
 }
 
 // -------------------------------------------------------------------------------------------------------------------
 // Hilevel handlers
 
 void hilevel_handler_rst( ctx_t* ctx ) {
+  spin_lock( &kernel_lock );
+
   PL011_putc( UART0, '[', true );
   PL011_putc( UART0, 'R', true );
   PL011_putc( UART0, ']', true );
 
+  /* Enable the MMU, which maps memory 1-to-1 except for the window used
+   * by processes executing an image loaded from disk.
+   */
+
+  vm_init();
+  vm_enable();
+  registry_init();
+  sched_init();
+  stats_init();
+  fpu_init();
+
   /* Configure the mechanism for interrupt handling by
    *
    * - configuring timer st. it raises a (periodic) interrupt for each
-   *   timer tick,
+   *   timer tick, which rebalances the runqueues (whereas the one-shot
+   *   timer, programmed on each dispatch, ends each time slice),
    * - configuring GIC st. the selected interrupts are forwarded to the
-   *   processor via the IRQ interrupt signal, then
-   * - enabling IRQ interrupts.
+   *   processor via the IRQ interrupt signal, each with a priority and
+   *   handlers (see irq.h), then
+   * - enabling IRQ interrupts, which happens once the console is entered
+   *   (rather than here, st. an interrupt is never taken in SVC mode
+   *   other than by another interrupt handler).
    */
 
-  TIMER0->Timer1Load  = 0x00100000; // select period = 2^20 ticks ~= 1 sec
+  TIMER0->Timer1Load  = RQ_BALANCE; // select period = 2^18 ticks ~= 250 ms
   TIMER0->Timer1Ctrl  = 0x00000002; // select 32-bit   timer
   TIMER0->Timer1Ctrl |= 0x00000040; // select periodic timer
   TIMER0->Timer1Ctrl |= 0x00000020; // enable          timer interrupt
   TIMER0->Timer1Ctrl |= 0x00000080; // enable          timer
 
+  tty_init( &ttys[ 0 ], UART0 );
+  tty_init( &ttys[ 1 ], UART1 );
+  dump_init();
+
   GICC0->PMR          = 0x000000F0; // unmask all            interrupts
-  GICD0->ISENABLER1  |= 0x00000010; // enable timer          interrupt
+  GICC0->BPR          = 0x00000003; // select preemption per priority bits 7:4, i.e., per IRQ_PRIO_*
+
+  irq_register( SGI_RESCHEDULE,    IRQ_PRIO_IPI,    NULL,        irq_resched_bh, NULL       );
+  irq_register( SGI_PROFILE,       IRQ_PRIO_IPI,    irq_profile, NULL,           NULL       );
+  irq_register( GIC_SOURCE_TIMER0, IRQ_PRIO_CLOCK,  irq_timer0,  irq_timer0_bh,  NULL       );
+  irq_register( GIC_SOURCE_TIMER1, IRQ_PRIO_CLOCK,  irq_timer1,  irq_timer1_bh,  NULL       );
+  irq_register( GIC_SOURCE_UART0,  IRQ_PRIO_DEVICE, NULL,        irq_tty_bh,     &ttys[ 0 ] );
+  irq_register( GIC_SOURCE_UART1,  IRQ_PRIO_DEVICE, NULL,        irq_tty_bh,     &ttys[ 1 ] );
+  irq_register( GIC_SOURCE_UART3,  IRQ_PRIO_DEVICE, NULL,        irq_dump_bh,    NULL       );
+
   GICC0->CTLR         = 0x00000001; // enable GIC interface
   GICD0->CTLR         = 0x00000001; // enable GIC distributor
 
   /* Initialise the console. Note that:
    * - the CPSR value of 0x50 means the processor is switched into USR mode,
    *   with IRQ interrupts enabled, and
-   * - the PC and SP values match the entry point and top of stack.
+   * - the PC and SP values match the entry point and top of stack, where
+   *   the entry point (and base priority) are registered like any other
+   *   program, and
+   * - a build can select another program to execute in its place (see
+   *   CONFIG_INIT), e.g., to execute benchmarks without any input, or
+   *   the console iff. no program has that name.
    */
 
+  const program_t* console = registry_find( CONFIG_INIT );
+
+  if( console == NULL ) {
+    console = registry_find( "console" );
+  }
+
   memset( &procTab[ 0 ], 0, sizeof( pcb_t ) ); // initialise 0-th PCB = console
   procTab[ 0 ].pid        = 0;
   procTab[ 0 ].status     = STATUS_CREATED;
   procTab[ 0 ].tos        = ( uint32_t )( &tos_procs );
+  procTab[ 0 ].tls        = procTab[ 0 ].tos - PROC_TLS;
   procTab[ 0 ].ctx.cpsr   = 0x50;
-  procTab[ 0 ].ctx.pc     = ( uint32_t )( &main_console );
-  procTab[ 0 ].ctx.sp     = procTab[ 0 ].tos;
-  procTab[ 0 ].b_priority = 1;
+  procTab[ 0 ].ctx.pc     = ( uint32_t )( console->entry );
+  procTab[ 0 ].ctx.sp     = procTab[ 0 ].tls;
+  procTab[ 0 ].b_priority = console->priority;
   procTab[ 0 ].age        = 0;
+  memset( ( void* )( procTab[ 0 ].tls ), 0, PROC_TLS );
+
+  /* The console reads from and writes to UART1, so its standard file
+   * descriptors all refer to the same tty1 file; processes it creates
+   * inherit them.
+   */
+
+  file_t* tty = file_open( "tty1" );
+  procTab[ 0 ].fd[ STDIN_FILENO  ] = tty;
+  procTab[ 0 ].fd[ STDOUT_FILENO ] = tty; file_dup( tty );
+  procTab[ 0 ].fd[ STDERR_FILENO ] = tty; file_dup( tty );
+
+  /* Initialise the idle process, which is executed (in USR mode) whenever
+   * every process in the process table is waiting; it is never entered
+   * into the process table itself, so never competes with them.
+   */
+
+  idle_init();
 
   /* Invalidate all other entries in the process table, so it's clear they are not
    * representing valid (i.e., active) processes.
@@ -157,216 +1363,327 @@ void hilevel_handler_rst( ctx_t* ctx ) {
   /* Once the PCBs are initialised, we select the 0-th PCB (console) to be
    * executed: there is no need to preserve the execution context, since it
    * is invalid on reset (i.e., no process was previously executing).
+   * Its time slice starts now, exactly as per schedule.
    */
 
   dispatch( ctx, NULL, &procTab[ 0 ] );
+  rq_charge( cpu_id(), NULL );
+  rq_arm( cpu_id(), &procTab[ 0 ] );
+
+  /* Wake the secondary CPUs (iff. any): each enters lolevel_handler_smp,
+   * but cannot get any further until the kernel lock is released.
+   */
+
+  if( MAX_CPUS > 1 ) {
+    smp_boot( &lolevel_handler_smp );
+  }
+
+  spin_unlock( &kernel_lock );
+
+  return;
+}
+
+/* Each secondary CPU enables the MMU and its GIC interface, then starts
+ * by executing its idle process: it is only scheduled a process once one
+ * is ready, e.g., after the next timer tick.
+ */
+
+void hilevel_handler_smp( ctx_t* ctx ) {
+  if( cpu_id() >= MAX_CPUS ) { // If not supported, park the CPU
+    while( 1 ) {
+      asm volatile( "wfi" );
+    }
+  }
+
+  spin_lock( &kernel_lock );
+
+  vm_enable();
+  stats_init();
+  fpu_init();
 
-  int_enable_irq();
+  GICC0->PMR          = 0x000000F0; // unmask all            interrupts
+  GICC0->BPR          = 0x00000003; // select preemption per priority bits 7:4, i.e., per IRQ_PRIO_*
+  irq_local();                      // enable SGIs, which are banked
+  GICC0->CTLR         = 0x00000001; // enable GIC interface
+
+  idle_init();
+
+  dispatch( ctx, NULL, &idle );
+  rq_charge( cpu_id(), NULL );
+
+  spin_unlock( &kernel_lock );
 
   return;
 }
 
+/* An interrupt is first handled by the top half registered for it (iff.
+ * any) with IRQs enabled, st. an interrupt of higher priority can nest,
+ * then acknowledged st. the GIC signals interrupts of any priority again.
+ * Only the outermost handler, i.e., that which interrupted a process (vs.
+ * another handler), goes on to execute the bottom halves deferred so
+ * far: it does so holding the kernel lock, and is the only one that can
+ * switch process, since it alone has a USR mode context to switch.
+ */
+
 void hilevel_handler_irq( ctx_t* ctx ) {
-  // Step 2: read  the interrupt identifier so we know the source.
+  // Step 2: read  the interrupt identifier so we know the source (for an SGI, IAR also captures the CPU which raised it).
 
-  uint32_t id = GICC0->IAR;
+  uint32_t iar = GICC0->IAR, id = iar & 0x3FF;
 
-  // Step 4: handle the interrupt, then clear (or reset) the source.
+  // Step 4: handle the top half of the interrupt, which clears (or resets) the source and defers the bottom half.
 
-  if( id == GIC_SOURCE_TIMER0 ) {
-    PL011_putc( UART0, '[', true );
-    PL011_putc( UART0, 'T', true );
-    PL011_putc( UART0, ']', true );
+  irq_top( id, ctx );
+
+  // Step 5: write the interrupt identifier to signal we're done.
+
+  GICC0->EOIR = iar;
+
+  if( ( ctx->cpsr & 0x1F ) != 0x10 ) {
+    return;
+  }
+
+  spin_lock( &kernel_lock );
 
+  pcb_t* entered = executing; stats_charge( entered, false );
+
+  for( int x; ( x = irq_next() ) != -1; ) {
+    TRACE( TRACE_IRQ_ENTER, x );
+
+    irq_bottom( x, ctx );
+
+    TRACE( TRACE_IRQ_EXIT,  x );
+  }
+
+  // If idle, or an interrupt made ready a process that should preempt, switch to it rather than wait for the next tick.
+
+  if( rq_preempt( cpu_id() ) ) {
     schedule( ctx );
-    TIMER0->Timer1IntClr = 0x01;
   }
 
-  // Step 5: write the interrupt identifier to signal we're done.
+  resched();
+
+  stats_charge( entered, true );
 
-  GICC0->EOIR = id;
+  spin_unlock( &kernel_lock );
 
   return;
 }
 
+/* A system call is first offered to the light path by the low-level
+ * handler, which preserves only r0 ... r3 (pointed to by gpr) plus the
+ * registers a C function may corrupt, rather than the whole execution
+ * context.  The call is made iff. it is light, per the syscall table, on
+ * a context holding only its arguments: if it completes, its return value
+ * is written back to r0 and the result is 0.  Otherwise (i.e., it is not
+ * light or has to block) the result is -1, st. the low-level handler
+ * preserves the whole context and the call is made via the full path
+ * instead; since a call that has to block has not changed anything, it
+ * is simply made again.  Note that because a light call cannot reschedule,
+ * a process it made ready which should preempt is switched to via an SGI
+ * this CPU raises for itself, i.e., as soon as the call returns.
+ */
+
+int hilevel_handler_svc_light( uint32_t* gpr, uint32_t id ) {
+  const syscall_t* s = ( id < SYSCALLS ) ? &syscalls[ id ] : NULL;
+
+  if( s == NULL || !s->light ) {
+    return -1;
+  }
+
+  ctx_t ctx; void* c = NULL;
+
+  ctx.gpr[ 0 ] = gpr[ 0 ];
+  ctx.gpr[ 1 ] = gpr[ 1 ];
+  ctx.gpr[ 2 ] = gpr[ 2 ];
+  ctx.gpr[ 3 ] = gpr[ 3 ];
+
+  spin_lock( &kernel_lock );
+
+  pcb_t* entered = executing; stats_charge( entered, false ); uint32_t t = trace_on ? clock_now() : 0;
+
+  if( !sys_check( s, &ctx ) ) {
+    ctx.gpr[ 0 ] = -1;
+  }
+  else {
+    c = s->fn( &ctx );
+  }
+
+  // Count and trace the call iff. it completed, since otherwise it is made again via the heavy path, which does both; the entry is as of when it was made
+  if( c == NULL ) {
+    TRACE_AT( TRACE_SVC_ENTER, id, t );
+
+    entered->stats.syscalls++; gpr[ 0 ] = ctx.gpr[ 0 ];
+
+    if( rq_preempt( cpu_id() ) ) {
+      smp_signal( cpu_id() );
+    }
+
+    resched();
+
+    TRACE( TRACE_SVC_EXIT, id );
+  }
+
+  stats_charge( entered, true );
+
+  spin_unlock( &kernel_lock );
+
+  return ( c == NULL ) ? 0 : -1;
+}
+
 void hilevel_handler_svc( ctx_t* ctx, uint32_t id ) {
   /* Based on the identifier (i.e., the immediate operand) extracted from the
    * svc instruction,
    *
-   * - read the arguments from preserved usr mode registers,
-   * - perform whatever is appropriate for this system call, then
-   * - write any return value back to preserved usr mode registers.
+   * - look up the system call in the syscall table (or return -1 iff. it
+   *   is unknown/unsupported),
+   * - validate the arguments in preserved usr mode registers, then
+   * - make the call, which writes any return value back to preserved usr
+   *   mode registers, or else blocks iff. it cannot complete yet.
    */
 
-  switch( id ) {
-    case 0x00 : { // 0x00 => yield()
-      PL011_putc( UART0, '[', true );
-      PL011_putc( UART0, 'Y', true );
-      PL011_putc( UART0, ']', true );
+  spin_lock( &kernel_lock );
 
-      schedule( ctx );
+  svc_ctx[ cpu_id() ] = ctx;
 
-      break;
-    }
-    case 0x01 : { // 0x01 => write( fd, x, n )
-      int   fd = ( int   )( ctx->gpr[ 0 ] );
-      char*  x = ( char* )( ctx->gpr[ 1 ] );
-      int    n = ( int   )( ctx->gpr[ 2 ] );
-
-      // Print
-      for( int i = 0; i < n; i++ ) {
-        PL011_putc( UART0, *x++, true );
-      }
+  pcb_t* entered = executing; stats_charge( entered, false ); entered->stats.syscalls++;
 
-      // Set return values
-      ctx->gpr[ 0 ] = n;
+  TRACE( TRACE_SVC_ENTER, id );
 
-      break;
-    }
-    case 0x03 : { // 0x03 -> fork()
-      PL011_putc( UART0, '[', true );
-      PL011_putc( UART0, 'F', true );
-      PL011_putc( UART0, ']', true );
-
-      // Get PCB
-      int idx = get_free_pcb_index();
-      if( idx == -1 ) { // If there's no free PCB left, return
-        ctx->gpr[0] = -1;
-        break;
-      }
-      pcb_t* child_pcb = &procTab[ idx ];
+  const syscall_t* s = ( id < SYSCALLS ) ? &syscalls[ id ] : NULL; void* c;
 
-      // Copy context from parent PCB to child PCB
-      memcpy( &child_pcb->ctx, ctx, sizeof( ctx_t ) );
+  if( s == NULL || s->fn == NULL || !sys_check( s, ctx ) ) {
+    ctx->gpr[ 0 ] = -1;
+  }
+  else if( ( c = s->fn( ctx ) ) != NULL ) {
+    block( ctx, c );
+  }
 
-      // Copy stack from parent PCB to child PCB
-      // memcpy() works from the bottom up
-      uint32_t parent_stack = executing->tos - PROC_SIZE;
-      uint32_t child_stack  = child_pcb->tos - PROC_SIZE;
-      memcpy( ( void* ) child_stack, ( void* ) parent_stack, PROC_SIZE );
+  // If the system call made ready a process that should preempt, switch to it
+  if( rq_preempt( cpu_id() ) ) {
+    schedule( ctx );
+  }
 
-      // Calculate offset for the sp of child PCB
-      uint32_t offset = (uint32_t)( executing->tos - ctx->sp );
+  svc_ctx[ cpu_id() ] = NULL;
 
-      // Create PCB and set the attributes
-      child_pcb->pid        = idx;
-      child_pcb->status     = STATUS_CREATED;
-      child_pcb->tos        = ( uint32_t )( &tos_procs ) - (idx * PROC_SIZE);
-      child_pcb->ctx.sp     = child_pcb->tos - offset;
-      child_pcb->b_priority = 1;
-      child_pcb->age        = 0;
+  resched();
 
-      // Set return values
-      ctx->gpr[0]           = child_pcb->pid; // Return value for parent
-      child_pcb->ctx.gpr[0] = 0;              // Return value for child
+  stats_charge( entered, true );
 
-      break;
-    }
-    case 0x04 : { // 0x04 => exit( status )
-      PL011_putc( UART0, '[', true );
-      PL011_putc( UART0, 'E', true );
-      PL011_putc( UART0, 'X', true );
-      PL011_putc( UART0, 'I', true );
-      PL011_putc( UART0, 'T', true );
-      PL011_putc( UART0, ']', true );
-
-      // Reset contents of PCB, indicate termination and re-schedule
-      memset( executing, 0, sizeof( pcb_t ) );
-      executing->status = STATUS_TERMINATED;
-      schedule( ctx );
+  TRACE( TRACE_SVC_EXIT, id );
 
-      break;
-    }
-    case 0x05 : { // 0x05 => exec( addr )
-      PL011_putc( UART0, '[', true );
-      PL011_putc( UART0, 'E', true );
-      PL011_putc( UART0, 'X', true );
-      PL011_putc( UART0, 'E', true );
-      PL011_putc( UART0, 'C', true );
-      PL011_putc( UART0, ']', true );
+  spin_unlock( &kernel_lock );
 
-      // Get entry point of process (E.g. &main_P3)
-      uint32_t addr = ( uint32_t )( ctx->gpr[ 0 ] );
+  return;
+}
 
-      // Set attributes
-      ctx->pc = addr;
-      ctx->sp = executing->tos;
+/* Translation faults within the VM window are resolved by mapping the
+ * page on demand (see vm.h); any other abort is fatal to the executing
+ * process.  Note the fault status encoding puts FSR[ 10 ] at bit 4.
+ *
+ * An abort raised by the kernel itself (e.g., accessing a buffer passed
+ * to a system call) happens while the kernel lock is held already, so
+ * the lock is only acquired iff. the abort was raised in USR mode.
+ */
 
-      break;
-    }
-    case 0x06 : { // 0x06 => kill( pid, x )
-      PL011_putc( UART0, '[', true );
-      PL011_putc( UART0, 'K', true );
-      PL011_putc( UART0, ']', true );
-
-      pid_t pid = ( pid_t )( ctx->gpr[ 0 ] );
-
-      // Get the PCB, reset it and indicate termination
-      pcb_t* target = get_pcb( pid );
-      if( target != NULL ) {
-        memset( target, 0, sizeof( pcb_t ) );
-        target->status = STATUS_TERMINATED;
-      }
+int hilevel_handler_abt( uint32_t far, uint32_t fsr ) {
+  uint32_t status = ( ( fsr >> 6 ) & 0x10 ) | ( fsr & 0x0F ), spsr; int r = -1;
 
-      break;
-    }
-    case 0x07 : { // 0x07 => nice( pid, x )
-      PL011_putc( UART0, '[', true );
-      PL011_putc( UART0, 'P', true );
-      PL011_putc( UART0, ']', true );
+  asm volatile( "mrs %0, spsr \n" // read SPSR, i.e., CPSR of whatever raised the abort
+              : "=r" (spsr) );
 
-      pid_t pid = ( pid_t )( ctx->gpr[ 0 ] );
-      int     x = (int    )( ctx->gpr[ 1 ] );
+  bool usr = ( spsr & 0x1F ) == 0x10;
 
-      // Get the PCB and set base priority to x
-      pcb_t* target = get_pcb( pid );
-      if( target != NULL ) target->b_priority = x;
-    }
-    case 0x08 : { // 0x08 => shm_open( uint32_t size )
-      uint32_t size = ( uint32_t )( ctx->gpr[ 0 ] );
+  if( usr ) {
+    spin_lock( &kernel_lock ); stats_charge( executing, false );
+  }
 
-      // Find unoccupied region
-      int idx = get_free_region_index();
-      if( idx == -1 ) { // If there's no free shm left, return
-        ctx->gpr[0] = -1;
-        break;
-      }
-      region* r = &regions[ idx ];
-    
-      // Set attributes
-      r->fd     = idx;
-      r->offset = ( idx != 0 ) ? ( regions[ idx - 1 ].offset - size ) : ( ( uint32_t ) ( &shm - size ) );
-      r->size   = size;
-      r->state  = OCCUPIED;
-    
-      // Set shared memory region
-      memset( ( void* )( r->offset ), 0, size );
-    
-      // Return fd
-      ctx->gpr[0] = idx;
-      break;
-    }
-    case 0x09 : { // 0x09 => mmap( int fd )
-      int fd = ( int )( ctx->gpr[ 0 ] );
+  if( status == 0x07 && executing != NULL && vm_fault( executing->vm, far ) ) { // translation fault (page)
+    r = 0;
+  }
 
-      // Return a pointer to the shm region
-      ctx->gpr[0] = regions[ fd ].offset;
+  if( usr ) {
+    if( status == 0x07 ) executing->stats.faults++;
 
-      break;
-    }
-    case 0x0A : { // 0x0A => shm_unlink( int fd )
-      int fd = ( int )( ctx->gpr[ 0 ] );
+    stats_charge( executing, true ); spin_unlock( &kernel_lock );
+  }
+
+  return r;
+}
 
-      // Reset contents of shm region
-      memset( ( void* )( regions[ fd ].offset ), 0, regions[ fd ].size );
+int hilevel_handler_und() {
+  uint32_t spsr; int r = -1;
 
-      break;
-    }
+  asm volatile( "mrs %0, spsr \n" // read SPSR, i.e., CPSR of whatever raised the exception
+              : "=r" (spsr) );
 
-    default   : { // 0x?? => unknown/unsupported
-      break;
+  // The kernel never uses VFP/NEON, so an undefined instruction it executes cannot be resolved
+  if( ( spsr & 0x1F ) != 0x10 ) {
+    return -1;
+  }
+
+  spin_lock( &kernel_lock ); stats_charge( executing, false );
+
+  if( executing != NULL && fpu_trap( executing ) ) { // VFP/NEON instruction, executed while disabled
+    r = 0;
+  }
+
+  stats_charge( executing, true ); spin_unlock( &kernel_lock );
+
+  return r;
+}
+
+/* An abort which cannot be resolved is fatal to the executing process,
+ * even iff. the kernel raised it while handling a system call made by it
+ * (e.g., on a bad pointer passed to the call): the call is abandoned, by
+ * resetting the SVC mode stack to where it was once the call was made,
+ * and the process terminated as if it had raised the abort itself.  Any
+ * other abort the kernel raises is a bug, so the CPU halts; this includes
+ * one raised by a light call, which preserves no context to abandon it
+ * with, but whose arguments are checked (or, per readv and writev, copied
+ * then checked) under the kernel lock, so cannot be invalidated.
+ */
+
+void hilevel_handler_seg( ctx_t* ctx ) {
+  ctx_t* x = ctx;
+
+  if( ( ctx->cpsr & 0x1F ) == 0x10 ) spin_lock( &kernel_lock ); // per hilevel_handler_abt
+
+  PL011_putc( UART0, '[', true );
+  PL011_putc( UART0, 'S', true );
+  PL011_putc( UART0, 'E', true );
+  PL011_putc( UART0, 'G', true );
+  PL011_putc( UART0, ']', true );
+
+  if( ( ctx->cpsr & 0x1F ) != 0x10 ) {
+    if( ( ctx->cpsr & 0x1F ) != 0x13 || svc_ctx[ cpu_id() ] == NULL ) {
+      while( 1 ) {
+        asm volatile( "wfi" );
+      }
     }
+
+    x = svc_ctx[ cpu_id() ]; svc_ctx[ cpu_id() ] = NULL;
+
+    asm volatile( "mrs r0, cpsr      \n" // preserve CPSR, i.e., of whichever mode took the abort
+                  "msr cpsr_c, #0xD3 \n" // enter SVC mode with IRQ and FIQ interrupts disabled
+                  "mov sp, %0        \n" // reset SVC mode SP, i.e., discard whatever the call pushed
+                  "msr cpsr_c, r0    \n" // restore CPSR
+                :
+                : "r" (x + 1)
+                : "r0" );
+  }
+
+  terminate( executing );
+  schedule( x );
+
+  if( x != ctx ) {
+    ctx_copy( ctx, x );                // return to whichever process is dispatched, rather than to the call
   }
 
+  resched();
+
+  stats_charge( NULL, true ); // i.e., discard, since the process that raised the abort is terminated
+
+  spin_unlock( &kernel_lock );
+
   return;
 }
@@ -25,7 +25,23 @@
 // Include functionality relating to the   kernel.
 
 #include "lolevel.h"
+#include     "mem.h"
 #include     "int.h"
+#include     "tty.h"
+#include    "file.h"
+#include     "shm.h"
+#include    "pipe.h"
+#include      "vm.h"
+#include   "image.h"
+#include "registry.h"
+#include     "smp.h"
+#include   "sched.h"
+#include   "stats.h"
+#include    "dump.h"
+#include   "trace.h"
+#include    "prof.h"
+#include     "fpu.h"
+#include     "irq.h"
 
 /* The kernel source code is made simpler and more consistent by using
  * some human-readable type definitions:
@@ -37,27 +53,19 @@
  * - a type that captures each component of an execution context (i.e.,
  *   processor state) in a compatible order wrt. the low-level handler
  *   preservation and restoration prologue and epilogue, and
- * - a type that captures a process PCB.
+ * - a type that captures a process PCB, and
+ * - a type that captures the state of each CPU, i.e., which process it
+ *   is executing.
+ *
+ * A thread is represented by a PCB like any other, and so is scheduled
+ * like any other: the difference is that it belongs to a group (i.e., the
+ * process that created it), whose address space and file descriptor table
+ * it shares.  It has its own stack, TLS and execution context.
  */
 
-extern uint32_t shm; // Address to shared memory
-
-#define MAX_SHM 20
-
-typedef enum { // Vacancy status of shm region
-  UNOCCUPIED,
-  OCCUPIED
-} vacancy;
-
-typedef struct {
-  int          fd; // file descriptor
-  uint32_t offset; // bottom of shm region
-  uint32_t   size; // size of shm region
-  vacancy   state; // region vacancy
-} region;
-
 #define MAX_PROCS 20
 #define PROC_SIZE 0x00001000
+#define PROC_TLS  0x00000200 // size of TLS area, reserved at the top of each process stack
 
 typedef int pid_t;
 
@@ -72,17 +80,103 @@ typedef enum {
   STATUS_WAITING
 } status_t;
 
-typedef struct {
+typedef struct ctx {
   uint32_t cpsr, pc, gpr[ 13 ], sp, lr;
 } ctx_t;
 
+// copy execution context y into x, i.e., memcpy specialised to the (fixed) 17 words of ctx_t, which are word-aligned
+static inline void ctx_copy( ctx_t* x, const ctx_t* y ) {
+  asm volatile( "ldmia %1!, { r2-r5 } \n" // copy cpsr, pc, gpr[  0 ... 1 ]
+                "stmia %0!, { r2-r5 } \n"
+                "ldmia %1!, { r2-r5 } \n" // copy       gpr[  2 ... 5 ]
+                "stmia %0!, { r2-r5 } \n"
+                "ldmia %1!, { r2-r5 } \n" // copy       gpr[  6 ... 9 ]
+                "stmia %0!, { r2-r5 } \n"
+                "ldmia %1!, { r2-r5 } \n" // copy       gpr[ 10 ... 12 ], sp
+                "stmia %0!, { r2-r5 } \n"
+                "ldr   r2, [ %1 ]     \n" // copy       lr
+                "str   r2, [ %0 ]     \n"
+              : "+r" (x), "+r" (y)
+              :
+              : "r2", "r3", "r4", "r5", "memory" );
+}
+
+#define MAX_ARGS   8         // maximum number of arguments per spawn, including the program name
+#define ARGS_SIZE  0x100     // maximum size of argument block per spawn, i.e., strings plus pointers
+
+#define MAX_IOV    16        // maximum number of buffers per readv or writev
+#define IOV_ATOMIC RING_SIZE // maximum number of bytes writev gathers into one (atomic) write
+
+typedef struct {
+    void* iov_base; // address of buffer
+  size_t  iov_len;  // length  of buffer
+} iovec_t;
+
+/* Each system call is described by an entry in the syscall table, which
+ * captures the handler, whether it can be made via the light path, and
+ * the kind of each argument (in r0 ... r2) st. it can be validated before
+ * the handler is invoked.
+ */
+
+#define SYS_ARGS        (  3 )
+
+#define SYS_ARG_ANY     (  0 ) // anything, e.g., an integer or PID the handler checks itself
+#define SYS_ARG_FD      (  1 ) // file descriptor, i.e., in [ 0, MAX_FDS )
+#define SYS_ARG_LEN     (  2 ) // length (or number) of buffer(s) in the previous argument, i.e., >= 0
+#define SYS_ARG_IN      (  3 ) // buffer the kernel reads,  of length per the next argument
+#define SYS_ARG_OUT     (  4 ) // buffer the kernel writes, of length per the next argument
+#define SYS_ARG_OBJ_IN  (  5 ) // (word-aligned) object the kernel reads,  of size bytes
+#define SYS_ARG_OBJ_OUT (  6 ) // (word-aligned) object the kernel writes, of size bytes
+#define SYS_ARG_STR     (  7 ) // NUL-terminated string the kernel reads
+#define SYS_ARG_IOV_IN  (  8 ) // array of buffers the kernel reads  (per writev), of length per the next argument
+#define SYS_ARG_IOV_OUT (  9 ) // array of buffers the kernel writes (per readv),  of length per the next argument
+#define SYS_ARG_ARGV    ( 10 ) // NULL, or NULL-terminated array of strings (per spawn)
+
+typedef struct {
+     void* ( *fn )( ctx_t* ctx ); // handler, which returns a wait channel iff. the call has to block, else NULL
+      bool light;                 // call can be made via the light path
+   uint8_t args[ SYS_ARGS ];      // kind of each argument
+  uint16_t size;                  // size of object, iff. an argument is SYS_ARG_OBJ_IN or SYS_ARG_OBJ_OUT
+} syscall_t;
+
+struct pcb {
+     pid_t          pid; // Process IDentifier (PID)
+  status_t       status; // current status
+  uint32_t          tos; // address of Top of Stack (ToS)
+  uint32_t          tls; // address of Thread-Local Storage (TLS), readable via TPIDRURO
+     ctx_t          ctx; // execution context
+     vfp_t          vfp; // VFP/NEON registers, iff. not held by a CPU (see fpu.h)
+       int      vfp_cpu; // CPU which last restored VFP/NEON registers
+       int   b_priority; // base priority
+       int          age; // time spent waiting since last executed
+     void*         wait; // wait channel iff. status = STATUS_WAITING
+   file_t*           fd[ MAX_FDS ]; // file descriptor table
+     vm_t*           vm; // address space iff. executing an image, else NULL
+     void*        group; // process the thread belongs to iff. a thread, else NULL
+       int          cpu; // CPU whose runqueue the process is on, or it last executed on
+      bool       queued; // process is on a runqueue
+    pcb_t*      rq_next; // next process on the same runqueue
+  uint32_t     enqueued; // time process was added to runqueue
+       int       policy; // scheduling class, e.g., SCHED_FAIR
+  uint32_t        slice; // time slice, or 0 iff. per class
+  uint64_t     vruntime; // SCHED_FAIR: virtual runtime
+  uint32_t       weight; // SCHED_FAIR: weight, as of when added to runqueue
+ rb_node_t           rb; // SCHED_FAIR or SCHED_EDF: node in runqueue
+  uint32_t   dl_runtime; // SCHED_EDF: runtime per period
+  uint32_t  dl_deadline; // SCHED_EDF: deadline relative to start of period
+  uint32_t    dl_period; // SCHED_EDF: period
+  uint32_t       dl_abs; // SCHED_EDF: absolute deadline of current period
+  uint32_t    dl_budget; // SCHED_EDF: runtime left in current period
+  uint32_t dl_replenish; // SCHED_EDF: time budget is replenished iff. throttled
+      bool dl_throttled; // SCHED_EDF: budget exhausted
+  uint32_t      dl_util; // SCHED_EDF: utilisation reserved
+       int       dl_cpu; // SCHED_EDF: CPU admitted onto
+  stats_t        stats; // accounting, e.g., cycles spent executing
+};
+
 typedef struct {
-     pid_t        pid; // Process IDentifier (PID)
-  status_t     status; // current status
-  uint32_t        tos; // address of Top of Stack (ToS)
-     ctx_t        ctx; // execution context
-       int b_priority; // base priority
-       int        age; // time spent waiting since last executed
-} pcb_t;
+  pcb_t*  current; // process executing on CPU, or NULL iff. CPU is offline
+  pcb_t  idle_pcb; // idle process executed on CPU iff. no other process can be
+} cpu_t;
 
 #endif
@@ -0,0 +1,209 @@
+#include "image.h"
+
+image_t images[ MAX_IMAGES ];
+
+static file_t*  image_disk = NULL; // disk, opened on first use
+static uint32_t image_time = 0;    // incremented per use of any image
+
+/* ELF (per the System V ABI and ARM ELF supplement) data structures, or
+ * at least those parts needed to load an executable.
+ */
+
+#define ELF_CLASS32  ( 1 )
+#define ELF_DATA2LSB ( 1 )
+#define ELF_EXEC     ( 2 )
+#define ELF_ARM      ( 40 )
+#define ELF_PT_LOAD  ( 1 )
+#define ELF_PF_W     ( 2 )
+
+typedef struct {
+   uint8_t e_ident[ 16 ];
+  uint16_t e_type, e_machine;
+  uint32_t e_version, e_entry, e_phoff, e_shoff, e_flags;
+  uint16_t e_ehsize, e_phentsize, e_phnum, e_shentsize, e_shnum, e_shstrndx;
+} elf_ehdr_t;
+
+typedef struct {
+  uint32_t p_type, p_offset, p_vaddr, p_paddr, p_filesz, p_memsz, p_flags, p_align;
+} elf_phdr_t;
+
+// Read n bytes into x from the disk at byte address a
+static bool image_rd( uint32_t a, void* x, int n ) {
+  if( image_disk == NULL && ( image_disk = file_open( "disk" ) ) == NULL ) {
+    return false;
+  }
+
+  image_disk->offset = a;
+
+  return image_disk->ops->read( image_disk, ( uint8_t* )( x ), n ) == n;
+}
+
+// Release frames caching pages of image x
+static void image_flush( image_t* x ) {
+  for( int i = 0; i < VM_PAGES; i++ ) {
+    if( x->pages[ i ] != 0 ) {
+      vm_frame_free( x->pages[ i ] ); x->pages[ i ] = 0;
+    }
+  }
+}
+
+// Look up image named x in the directory, then read and check the headers into image r
+static bool image_load( image_t* r, const char* x ) {
+  image_dirent_t e; elf_ehdr_t h; elf_phdr_t p;
+
+  for( int i = 0; true; i++ ) {
+    if( i == IMAGE_DIR_ENTRIES || !image_rd( i * sizeof( e ), &e, sizeof( e ) ) || e.name[ 0 ] == '\0' ) {
+      return false;
+    }
+    if( 0 == strncmp( e.name, x, IMAGE_NAME ) ) {
+      break;
+    }
+  }
+
+  if( !image_rd( e.offset, &h, sizeof( h ) ) ) {
+    return false;
+  }
+  if( h.e_ident[ 0 ] != 0x7F || h.e_ident[ 1 ] != 'E' || h.e_ident[ 2 ] != 'L' || h.e_ident[ 3 ] != 'F' ||
+      h.e_ident[ 4 ] != ELF_CLASS32 || h.e_ident[ 5 ] != ELF_DATA2LSB ||
+      h.e_type != ELF_EXEC || h.e_machine != ELF_ARM || h.e_phentsize != sizeof( p ) ) {
+    return false;
+  }
+
+  memset( r, 0, sizeof( image_t ) );
+
+  for( int i = 0; i < h.e_phnum; i++ ) {
+    if( !image_rd( e.offset + h.e_phoff + ( i * sizeof( p ) ), &p, sizeof( p ) ) ) {
+      return false;
+    }
+    if( p.p_type != ELF_PT_LOAD || p.p_memsz == 0 ) {
+      continue;
+    }
+
+    // Each segment must fit within the window (minus the stack), and within the image
+    if( r->segs_n == MAX_SEGS || p.p_filesz > p.p_memsz || p.p_vaddr < VM_BASE || p.p_vaddr >= ( VM_TOP - VM_STACK ) ||
+        p.p_memsz > ( VM_TOP - VM_STACK - p.p_vaddr ) || ( p.p_offset + p.p_filesz ) > e.size ) {
+      return false;
+    }
+
+    segment_t* s = &r->segs[ r->segs_n++ ];
+
+    s->vaddr  = p.p_vaddr;  s->memsz  = p.p_memsz;
+    s->offset = p.p_offset; s->filesz = p.p_filesz;
+    s->write  = ( p.p_flags & ELF_PF_W ) != 0;
+  }
+
+  strncpy( r->name, x, IMAGE_NAME );
+  r->offset = e.offset;
+  r->entry  = h.e_entry;
+
+  return r->segs_n > 0;
+}
+
+image_t* image_get( const char* x ) {
+  image_t* r = NULL;
+
+  if( strlen( x ) >= IMAGE_NAME ) {
+    return NULL;
+  }
+
+  // Hit: the image is cached already
+  for( int i = 0; i < MAX_IMAGES && r == NULL; i++ ) {
+    if( images[ i ].name[ 0 ] != '\0' && 0 == strncmp( images[ i ].name, x, IMAGE_NAME ) ) r = &images[ i ];
+  }
+
+  // Miss: evict whichever unused image was least recently used (if any), and load the image in its place
+  if( r == NULL ) {
+    for( int i = 0; i < MAX_IMAGES; i++ ) {
+      if( images[ i ].refs == 0 && ( r == NULL || images[ i ].used < r->used ) ) r = &images[ i ];
+    }
+
+    if( r == NULL ) {
+      return NULL;
+    }
+
+    image_flush( r );
+
+    if( !image_load( r, x ) ) {
+      memset( r, 0, sizeof( image_t ) ); return NULL;
+    }
+  }
+
+  r->refs++;
+  r->used = ++image_time;
+
+  return r;
+}
+
+void     image_dup( image_t* x ) {
+  x->refs++;
+}
+
+void     image_put( image_t* x ) {
+  x->refs--;
+}
+
+uint32_t image_page( image_t* x, uint32_t v, bool* shared ) {
+  int i = ( v - VM_BASE ) / VM_PAGE; bool valid = false;
+
+  /* The page is valid iff. some segment overlaps it, and can be shared
+   * iff. no segment overlapping it is writable.
+   */
+
+  *shared = true;
+
+  for( int j = 0; j < x->segs_n; j++ ) {
+    segment_t* s = &x->segs[ j ];
+
+    if( s->vaddr < ( v + VM_PAGE ) && v < ( s->vaddr + s->memsz ) ) {
+      valid = true; *shared &= !s->write;
+    }
+  }
+
+  if( !valid ) {
+    return 0;
+  }
+  if( *shared && x->pages[ i ] != 0 ) {
+    vm_frame_dup( x->pages[ i ] ); return x->pages[ i ];
+  }
+
+  // Fill frame with overlapping part of each segment in the image, and zero elsewhere (e.g., bss)
+  uint32_t f = vm_frame_alloc();
+
+  if( f == 0 ) {
+    return 0;
+  }
+
+  mem_zero( ( void* )( f ), VM_PAGE );
+
+  for( int j = 0; j < x->segs_n; j++ ) {
+    segment_t* s = &x->segs[ j ];
+
+    uint32_t lo = ( s->vaddr > v ) ? s->vaddr : v;
+    uint32_t hi = ( ( s->vaddr + s->filesz ) < ( v + VM_PAGE ) ) ? ( s->vaddr + s->filesz ) : ( v + VM_PAGE );
+
+    if( lo < hi && !image_rd( x->offset + s->offset + ( lo - s->vaddr ), ( void* )( f + ( lo - v ) ), hi - lo ) ) {
+      vm_frame_free( f ); return 0;
+    }
+  }
+
+  // Cache page iff. shared, st. the cache holds a reference in addition to the caller
+  if( *shared ) {
+    vm_frame_dup( f ); x->pages[ i ] = f;
+  }
+
+  return f;
+}
+
+bool     image_reclaim() {
+  bool r = false;
+
+  for( int i = 0; i < MAX_IMAGES; i++ ) {
+    if( images[ i ].refs == 0 ) {
+      for( int j = 0; j < VM_PAGES; j++ ) r |= ( images[ i ].pages[ j ] != 0 );
+
+      image_flush( &images[ i ] );
+    }
+  }
+
+  return r;
+}
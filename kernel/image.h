@@ -0,0 +1,70 @@
+#ifndef __IMAGE_H
+#define __IMAGE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string.h>
+
+#include  "file.h"
+#include    "vm.h"
+
+/* An image is a program stored on disk as an (ARM, 32-bit, executable)
+ * ELF file, linked st. it executes within the VM window.  The disk starts
+ * with a directory of IMAGE_DIR_ENTRIES entries, each of which captures
+ * the name, disk address and size of an image; the first entry with an
+ * empty name terminates the directory.
+ *
+ * Images are loaded lazily: loading an image only reads and checks the
+ * ELF and program headers, whereas each page is read from disk once the
+ * first process to execute the image touches it (see vm.h).  Recently
+ * loaded images are cached, along with any read-only pages read so far:
+ * executing an image again (or concurrently) therefore needs neither the
+ * headers nor those pages to be read again.  An image that no process is
+ * using is evicted once the cache is full, and its pages reclaimed once
+ * the frames are needed.
+ */
+
+#define MAX_IMAGES        (  4 )
+#define MAX_SEGS          (  4 )
+
+#define IMAGE_NAME        ( 24 )
+#define IMAGE_DIR_ENTRIES ( 64 )
+
+typedef struct {
+      char name[ IMAGE_NAME ]; // name, or empty iff. end of directory
+  uint32_t offset;             // disk address of image
+  uint32_t size;               // size        of image
+} image_dirent_t;
+
+typedef struct {
+  uint32_t vaddr,  memsz;      // address and size of segment in memory
+  uint32_t offset, filesz;     // offset  and size of segment in image
+      bool write;              // segment is writable
+} segment_t;
+
+struct image {
+      char name[ IMAGE_NAME ]; // name, or empty iff. unused
+  uint32_t offset;             // disk address of image
+  uint32_t entry;              // entry point
+ segment_t segs[ MAX_SEGS ];   // loadable segments
+       int segs_n;             // number of loadable segments
+  uint32_t pages[ VM_PAGES ];  // frames caching read-only pages, or 0 iff. not cached
+       int refs;               // number of address spaces mapping image
+  uint32_t used;               // time of last use, st. least recently used image is evicted first
+};
+
+// find image named x, in the cache or else on disk, and add a reference to it; return NULL iff. none is valid
+extern image_t* image_get( const char* x );
+// add    a reference to   image x
+extern void     image_dup( image_t* x );
+// remove a reference from image x (which remains cached)
+extern void     image_put( image_t* x );
+
+// return frame (with a reference for the caller) holding the page at address v of image x, and set shared iff. read-only; return 0 iff. v is invalid
+extern uint32_t image_page( image_t* x, uint32_t v, bool* shared );
+// release frames caching pages of images no address space maps; return true iff. any were released
+extern bool     image_reclaim();
+
+#endif
@@ -0,0 +1,84 @@
+#include "irq.h"
+
+#define IRQ_WORDS ( IRQ_SOURCES / 32 )
+
+static irq_t    irqs[ IRQ_SOURCES ];
+static uint32_t irq_pending[ MAX_CPUS ][ IRQ_WORDS ]; // bottom halves deferred, per CPU, i.e., bit i of word j for ID 32j + i
+
+// An interrupt is masked while its bottom half is deferred iff. it has no top half, and is not an SGI
+static bool irq_oneshot( int id ) {
+  return irqs[ id ].top == NULL && id >= 16;
+}
+
+void irq_register( int id, uint8_t prio, irq_top_t top, irq_bottom_t bottom, void* data ) {
+  irqs[ id ].top    = top;
+  irqs[ id ].bottom = bottom;
+  irqs[ id ].data   = data;
+  irqs[ id ].prio   = prio;
+
+  ( ( uint8_t* )( GICD0->IPRIORITYR ) )[ id ] = prio; // select priority
+
+  if( id >= 32 ) {
+    ( ( uint8_t* )( GICD0->ITARGETSR  ) )[ id ] = 0x01; // forward device interrupt to CPU 0
+  }
+
+  ( &GICD0->ISENABLER0 )[ id >> 5 ] = 1 << ( id & 31 ); // enable interrupt
+}
+
+void irq_local() {
+  for( int id = 0; id < 32; id++ ) {
+    if( irqs[ id ].top != NULL || irqs[ id ].bottom != NULL ) {
+      ( ( uint8_t* )( GICD0->IPRIORITYR ) )[ id ] = irqs[ id ].prio;
+
+      GICD0->ISENABLER0 = 1 << id;
+    }
+  }
+}
+
+void irq_top( int id, struct ctx* ctx ) {
+  if( id >= IRQ_SOURCES ) { // e.g., spurious (i.e., ID 1023)
+    return;
+  }
+
+  irq_t* x = &irqs[ id ]; bool defer = true;
+
+  if( irq_oneshot( id ) ) {
+    ( &GICD0->ICENABLER0 )[ id >> 5 ] = 1 << ( id & 31 );
+  }
+
+  if( x->top != NULL ) {
+    int_enable_irq(); defer = x->top( ctx, x->data ); int_unable_irq();
+  }
+
+  if( defer && x->bottom != NULL ) {
+    irq_pending[ cpu_id() ][ id >> 5 ] |= 1 << ( id & 31 );
+  }
+}
+
+int  irq_next() {
+  uint32_t* p = irq_pending[ cpu_id() ]; int r = -1;
+
+  for( int i = 0; i < IRQ_WORDS; i++ ) {
+    for( uint32_t t = p[ i ]; t != 0; t &= t - 1 ) {
+      int id = ( i << 5 ) + __builtin_ctz( t );
+
+      if( r == -1 || irqs[ id ].prio < irqs[ r ].prio ) r = id;
+    }
+  }
+
+  if( r != -1 ) {
+    p[ r >> 5 ] &= ~( 1 << ( r & 31 ) );
+  }
+
+  return r;
+}
+
+void irq_bottom( int id, struct ctx* ctx ) {
+  irq_t* x = &irqs[ id ];
+
+  int_enable_irq(); x->bottom( ctx, x->data ); int_unable_irq();
+
+  if( irq_oneshot( id ) ) {
+    ( &GICD0->ISENABLER0 )[ id >> 5 ] = 1 << ( id & 31 );
+  }
+}
@@ -0,0 +1,65 @@
+#ifndef __IRQ_H
+#define __IRQ_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include   "GIC.h"
+
+#include   "int.h"
+#include   "smp.h"
+
+/* Each interrupt the kernel handles is registered in a table keyed by
+ * its ID, which captures a priority and two handlers:
+ *
+ * - the top half is executed in hard-IRQ context, i.e., as soon as the
+ *   interrupt is taken, but with IRQs enabled st. an interrupt of higher
+ *   priority (per the GIC) can nest; it must only touch the device (plus
+ *   anything with its own lock, e.g., the profiler), since it executes
+ *   without the kernel lock, and returns true iff. the bottom half has
+ *   work to do,
+ * - the bottom half is deferred until the outermost handler, i.e., that
+ *   which interrupted a process, is about to return: bottom halves are
+ *   then executed in priority order, holding the kernel lock but again
+ *   with IRQs enabled, st. even a slow one (e.g., a tty) delays the top
+ *   half of a timer by no more than it takes to enter the handler.
+ *
+ * An interrupt without a top half is masked at the distributor once
+ * taken (unless an SGI, which cannot be) and unmasked once the bottom
+ * half is executed, st. a level-sensitive device cannot raise it again
+ * in the mean time.  The GIC only signals an interrupt of higher priority
+ * than any being handled, so nesting is at most one deep per priority.
+ */
+
+#define IRQ_SOURCES     ( 96 )   // number of IDs, per IPRIORITYR and ITARGETSR
+
+#define IRQ_PRIO_CLOCK  ( 0x20 ) // timers, i.e., time slices, rebalancing and profiling
+#define IRQ_PRIO_IPI    ( 0x40 ) // SGIs, i.e., from other CPUs
+#define IRQ_PRIO_DEVICE ( 0x80 ) // devices, e.g., UARTs
+
+struct ctx;
+
+typedef bool ( *irq_top_t    )( struct ctx* ctx, void* data );
+typedef void ( *irq_bottom_t )( struct ctx* ctx, void* data );
+
+typedef struct {
+     irq_top_t    top; // top    half, or NULL iff. none
+  irq_bottom_t bottom; // bottom half, or NULL iff. none
+         void*   data; // passed to either, e.g., a tty
+       uint8_t   prio; // priority, st. lower is more urgent
+} irq_t;
+
+// register top and bottom half for interrupt id with priority prio, then enable it (forwarded to CPU 0, iff. not an SGI or PPI)
+extern void irq_register( int id, uint8_t prio, irq_top_t top, irq_bottom_t bottom, void* data );
+// apply priority and enable each SGI or PPI registered, on this CPU (since they are banked per CPU)
+extern void irq_local   ();
+
+// execute top half of interrupt id taken on this CPU, which interrupted ctx, then defer bottom half (iff. any)
+extern void irq_top     ( int id, struct ctx* ctx );
+// return ID of most urgent interrupt whose bottom half is deferred on this CPU, or -1 iff. none
+extern int  irq_next    ();
+// execute bottom half of interrupt id (per irq_next), with ctx as interrupted by the outermost handler
+extern void irq_bottom  ( int id, struct ctx* ctx );
+
+#endif
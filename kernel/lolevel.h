@@ -8,4 +8,7 @@
 #ifndef __LOLEVEL_H
 #define __LOLEVEL_H
 
+// entry point of each secondary CPU, once woken
+extern void lolevel_handler_smp();
+
 #endif
@@ -11,13 +11,21 @@
  */
 
 .global lolevel_handler_rst
+.global lolevel_handler_smp
 .global lolevel_handler_irq
+.global lolevel_handler_und
 .global lolevel_handler_svc
+.global lolevel_handler_pab
+.global lolevel_handler_dab
 
 lolevel_handler_rst: bl    int_init                @ initialise interrupt vector table
 
                      msr   cpsr, #0xD2             @ enter IRQ mode with IRQ and FIQ interrupts disabled
                      ldr   sp, =tos_irq            @ initialise IRQ mode stack
+                     msr   cpsr, #0xD7             @ enter ABT mode with IRQ and FIQ interrupts disabled
+                     ldr   sp, =tos_abt            @ initialise ABT mode stack
+                     msr   cpsr, #0xDB             @ enter UND mode with IRQ and FIQ interrupts disabled
+                     ldr   sp, =tos_und            @ initialise UND mode stack
                      msr   cpsr, #0xD3             @ enter SVC mode with IRQ and FIQ interrupts disabled
                      ldr   sp, =tos_svc            @ initialise SVC mode stack
 
@@ -30,6 +38,49 @@ lolevel_handler_rst: bl    int_init                @ initialise interrupt vector
                      add   sp, sp, #60             @ update   SVC mode SP
                      movs  pc, lr                  @ return from interrupt
 
+/* Each secondary CPU is woken once the primary CPU has been reset, and
+ * enters here: the interrupt vector table is initialised already, but
+ * the CPU needs its own IRQ, SVC, ABT and UND mode stacks, i.e., those at the
+ * top of the corresponding stack space minus 0x1000 bytes per CPU ID.
+ */
+
+lolevel_handler_smp: mrc   p15, 0, r4, c0, c0, 5   @ read     MPIDR
+                     and   r4, r4, #0x3            @ compute  CPU ID
+                     mov   r4, r4, lsl #12         @ compute  stack offset = CPU ID * 0x1000
+
+                     msr   cpsr, #0xD2             @ enter IRQ mode with IRQ and FIQ interrupts disabled
+                     ldr   sp, =tos_irq            @ initialise IRQ mode stack
+                     sub   sp, sp, r4
+                     msr   cpsr, #0xD7             @ enter ABT mode with IRQ and FIQ interrupts disabled
+                     ldr   sp, =tos_abt            @ initialise ABT mode stack
+                     sub   sp, sp, r4
+                     msr   cpsr, #0xDB             @ enter UND mode with IRQ and FIQ interrupts disabled
+                     ldr   sp, =tos_und            @ initialise UND mode stack
+                     sub   sp, sp, r4
+                     msr   cpsr, #0xD3             @ enter SVC mode with IRQ and FIQ interrupts disabled
+                     ldr   sp, =tos_svc            @ initialise SVC mode stack
+                     sub   sp, sp, r4
+
+                     sub   sp, sp, #68             @ allocate execution context
+                     mov   r0, sp                  @ set    high-level C function arg. = SP
+                     bl    hilevel_handler_smp     @ invoke high-level C function
+
+                     ldmia sp!, { r0, lr }         @ load     USR mode PC and CPSR
+                     msr   spsr, r0                @ move     USR mode        CPSR
+                     ldmia sp, { r0-r12, sp, lr }^ @ restore  USR mode registers
+                     add   sp, sp, #60             @ update   SVC mode SP
+                     movs  pc, lr                  @ return from interrupt
+
+/* An IRQ interrupt preserves the USR mode registers on the IRQ mode stack
+ * as usual, but the high-level handler then executes in SVC mode, on the
+ * SVC mode stack, st. it can enable IRQ interrupts (see irq.h): a nested
+ * interrupt then only overwrites the IRQ mode LR and SPSR, which are
+ * preserved already.  Since a nested interrupt interrupts SVC mode, it
+ * also preserves the SVC mode LR of whichever handler it interrupted
+ * (whereas the USR mode registers are simply restored as they were), and
+ * aligns the SVC mode SP to 8 bytes per AAPCS, since it need not be.
+ */
+
 lolevel_handler_irq: sub   lr, lr, #4              @ correct return address
                      sub   sp, sp, #60             @ update   IRQ mode stack
                      stmia sp, { r0-r12, sp, lr }^ @ preserve USR registers
@@ -37,7 +88,14 @@ lolevel_handler_irq: sub   lr, lr, #4              @ correct return address
                      stmdb sp!, { r0, lr }         @ store    USR PC and CPSR
 
                      mov   r0, sp                  @ set    high-level C function arg. = SP
+                     msr   cpsr_c, #0xD3           @ enter SVC mode with IRQ and FIQ interrupts disabled
+                     and   r1, sp, #4              @ compute  SVC mode SP alignment
+                     sub   sp, sp, r1              @ align    SVC mode SP
+                     stmdb sp!, { r1, lr }         @ preserve SVC mode SP alignment and LR
                      bl    hilevel_handler_irq     @ invoke high-level C function
+                     ldmia sp!, { r1, lr }         @ restore  SVC mode SP alignment and LR
+                     add   sp, sp, r1              @ restore  SVC mode SP
+                     msr   cpsr_c, #0xD2           @ enter IRQ mode with IRQ and FIQ interrupts disabled
 
                      ldmia sp!, { r0, lr }         @ load     USR mode PC and CPSR
                      msr   spsr, r0                @ move     USR mode        CPSR
@@ -45,7 +103,24 @@ lolevel_handler_irq: sub   lr, lr, #4              @ correct return address
                      add   sp, sp, #60             @ update   IRQ mode SP
                      movs  pc, lr                  @ return from interrupt
 
-lolevel_handler_svc: sub   lr, lr, #0              @ correct return address
+/* A system call is first offered to the light path, which (like an
+ * abort) only preserves the registers a C function may corrupt: the
+ * high-level handler completes the call iff. it never reschedules (see
+ * hilevel_handler_svc_light), writing the return value over the preserved
+ * r0.  Otherwise, the USR mode registers are preserved as for any other
+ * interrupt, and the call is made via the full path.
+ */
+
+lolevel_handler_svc: stmdb sp!, { r0-r3, ip, lr }  @ preserve scratch registers
+                     mov   r0, sp                  @ set    high-level C function arg. = SP, i.e., USR r0-r3
+                     ldr   r1, [ lr, #-4 ]         @ load                     svc instruction
+                     bic   r1, r1, #0xFF000000     @ set    high-level C function arg. = svc immediate
+                     bl    hilevel_handler_svc_light @ invoke high-level C function
+                     cmp   r0, #0                  @ completed iff. result = 0
+                     ldmia sp!, { r0-r3, ip, lr }  @ restore  scratch registers, incl. result in r0 iff. completed
+                     moveqs pc, lr                 @ return from interrupt iff. completed
+
+                     sub   lr, lr, #0              @ correct return address
                      sub   sp, sp, #60             @ update   SVC mode stack
                      stmia sp, { r0-r12, sp, lr }^ @ preserve USR registers
                      mrs   r0, spsr                @ move     USR        CPSR
@@ -61,3 +136,59 @@ lolevel_handler_svc: sub   lr, lr, #0              @ correct return address
                      ldmia sp, { r0-r12, sp, lr }^ @ restore  USR mode registers
                      add   sp, sp, #60             @ update   SVC mode SP
                      movs  pc, lr                  @ return from interrupt
+
+/* An abort is first offered to a high-level handler which may resolve
+ * it (e.g., by mapping a page on demand), in which case the instruction
+ * is simply retried: doing so only requires the registers a C function
+ * may corrupt to be preserved, and works whether the abort was raised by
+ * a USR mode process or by the kernel (e.g., accessing a buffer passed
+ * to a system call).  Otherwise, the USR mode registers are preserved
+ * as for any other interrupt st. the process can be terminated.
+ */
+
+lolevel_handler_pab: sub   lr, lr, #4              @ correct return address
+                     stmdb sp!, { r0-r3, ip, lr }  @ preserve scratch registers
+                     mrc   p15, 0, r0, c6, c0, 2   @ set    high-level C function arg. = IFAR
+                     mrc   p15, 0, r1, c5, c0, 1   @ set    high-level C function arg. = IFSR
+                     bl    hilevel_handler_abt     @ invoke high-level C function
+                     cmp   r0, #0                  @ resolved iff. result = 0
+                     ldmia sp!, { r0-r3, ip, lr }  @ restore  scratch registers
+                     moveqs pc, lr                 @ return from interrupt iff. resolved
+                     b     lolevel_handler_seg
+
+lolevel_handler_dab: sub   lr, lr, #8              @ correct return address
+                     stmdb sp!, { r0-r3, ip, lr }  @ preserve scratch registers
+                     mrc   p15, 0, r0, c6, c0, 0   @ set    high-level C function arg. = DFAR
+                     mrc   p15, 0, r1, c5, c0, 0   @ set    high-level C function arg. = DFSR
+                     bl    hilevel_handler_abt     @ invoke high-level C function
+                     cmp   r0, #0                  @ resolved iff. result = 0
+                     ldmia sp!, { r0-r3, ip, lr }  @ restore  scratch registers
+                     moveqs pc, lr                 @ return from interrupt iff. resolved
+                     b     lolevel_handler_seg
+
+/* An undefined instruction is handled likewise: the high-level handler
+ * may resolve it iff. it is a VFP or NEON instruction executed while the
+ * registers are switched out (see fpu.h), in which case it is retried.
+ */
+
+lolevel_handler_und: sub   lr, lr, #4              @ correct return address
+                     stmdb sp!, { r0-r3, ip, lr }  @ preserve scratch registers
+                     bl    hilevel_handler_und     @ invoke high-level C function
+                     cmp   r0, #0                  @ resolved iff. result = 0
+                     ldmia sp!, { r0-r3, ip, lr }  @ restore  scratch registers
+                     moveqs pc, lr                 @ return from interrupt iff. resolved
+                     b     lolevel_handler_seg
+
+lolevel_handler_seg: sub   sp, sp, #60             @ update   ABT (or UND) mode stack
+                     stmia sp, { r0-r12, sp, lr }^ @ preserve USR registers
+                     mrs   r0, spsr                @ move     USR        CPSR
+                     stmdb sp!, { r0, lr }         @ store    USR PC and CPSR
+
+                     mov   r0, sp                  @ set    high-level C function arg. = SP
+                     bl    hilevel_handler_seg     @ invoke high-level C function
+
+                     ldmia sp!, { r0, lr }         @ load     USR mode PC and CPSR
+                     msr   spsr, r0                @ move     USR mode        CPSR
+                     ldmia sp, { r0-r12, sp, lr }^ @ restore  USR mode registers
+                     add   sp, sp, #60             @ update   ABT (or UND) mode SP
+                     movs  pc, lr                  @ return from interrupt
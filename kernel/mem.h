@@ -0,0 +1,25 @@
+#ifndef __MEM_H
+#define __MEM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* The kernel copies and zeroes memory on several hot paths, e.g., the
+ * stack copied by fork, a PCB zeroed as a process terminates, or a page
+ * filled on demand; the routines below replace memcpy and memset there.
+ * Each moves 32 bytes per iteration via ldm/stm bursts of 8 registers
+ * (with pld prefetching the source ahead, for a copy) iff. every address
+ * is word-aligned, then copies or zeroes any remainder a word, then a
+ * byte at a time; unaligned addresses use the byte loop throughout.
+ *
+ * NEON would move more per instruction, but the kernel never uses the
+ * VFP/NEON registers, st. they can be switched lazily (see fpu.h).
+ */
+
+// copy n bytes from y into x (which must not overlap)
+extern void mem_copy( void* x, const void* y, size_t n );
+// zero n bytes at x
+extern void mem_zero( void* x, size_t n );
+
+#endif
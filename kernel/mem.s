@@ -0,0 +1,71 @@
+/* Copyright (C) 2017 Daniel Page <csdsp@bristol.ac.uk>
+ *
+ * Use of this source code is restricted per the CC BY-NC-ND license, a copy of 
+ * which can be found via http://creativecommons.org (and should be included as 
+ * LICENSE.txt within the associated archive or repository).
+ */
+
+/* The following copy and zero memory (see mem.h): each first checks the
+ * alignment, then, iff. word-aligned, moves blocks of 32 bytes using one
+ * ldm and/or stm of 8 registers, then any remaining words, then bytes.
+ * The Cortex-A8 L1 data cache has 64-byte lines, so a pld 2 lines ahead
+ * of the source keeps a copy from stalling on each line fill.
+ */
+
+.global mem_copy
+.global mem_zero
+
+mem_copy:            orr   r3, r0, r1              @ compute x | y
+                     tst   r3, #0x3
+                     bne   mem_copy_bytes          @ copy bytes  iff. either is unaligned
+
+                     stmdb sp!, { r4-r10 }         @ preserve callee-saved registers
+                     subs  r2, r2, #32
+                     blt   mem_copy_words
+mem_copy_block:      pld   [ r1, #128 ]            @ prefetch source 2 lines ahead
+                     ldmia r1!, { r3-r10 }         @ load  32 bytes, inc. source      address
+                     stmia r0!, { r3-r10 }         @ store 32 bytes, inc. destination address
+                     subs  r2, r2, #32
+                     bge   mem_copy_block          @ loop iff. >= 32 bytes remain
+mem_copy_words:      add   r2, r2, #32
+                     ldmia sp!, { r4-r10 }         @ restore  callee-saved registers
+mem_copy_word:       subs  r2, r2, #4
+                     ldrge r3, [ r1 ], #4          @ load  word, inc. source      address
+                     strge r3, [ r0 ], #4          @ store word, inc. destination address
+                     bge   mem_copy_word           @ loop iff. >=  4 bytes remained
+                     add   r2, r2, #4
+mem_copy_bytes:      subs  r2, r2, #1
+                     ldrgeb r3, [ r1 ], #1         @ load  byte, inc. source      address
+                     strgeb r3, [ r0 ], #1         @ store byte, inc. destination address
+                     bgt   mem_copy_bytes          @ loop iff. >=  1 byte  remains
+
+                     mov   pc, lr                  @ return
+
+mem_zero:            mov   r2, #0
+                     tst   r0, #0x3
+                     bne   mem_zero_bytes          @ zero bytes  iff. x is unaligned
+
+                     stmdb sp!, { r4-r9 }          @ preserve callee-saved registers
+                     mov   r3, #0
+                     mov   r4, #0
+                     mov   r5, #0
+                     mov   r6, #0
+                     mov   r7, #0
+                     mov   r8, #0
+                     mov   r9, #0
+                     subs  r1, r1, #32
+                     blt   mem_zero_words
+mem_zero_block:      stmia r0!, { r2-r9 }          @ store 32 bytes, inc. destination address
+                     subs  r1, r1, #32
+                     bge   mem_zero_block          @ loop iff. >= 32 bytes remain
+mem_zero_words:      add   r1, r1, #32
+                     ldmia sp!, { r4-r9 }          @ restore  callee-saved registers
+mem_zero_word:       subs  r1, r1, #4
+                     strge r2, [ r0 ], #4          @ store word, inc. destination address
+                     bge   mem_zero_word           @ loop iff. >=  4 bytes remained
+                     add   r1, r1, #4
+mem_zero_bytes:      subs  r1, r1, #1
+                     strgeb r2, [ r0 ], #1         @ store byte, inc. destination address
+                     bgt   mem_zero_bytes          @ loop iff. >=  1 byte  remains
+
+                     mov   pc, lr                  @ return
@@ -0,0 +1,81 @@
+#include "pipe.h"
+
+extern void wake( void* c );
+
+pipe_t pipes[ MAX_PIPES ];
+
+static int  pipe_file_read ( file_t* f,       uint8_t* x, int n ) {
+  pipe_t* p = ( pipe_t* )( f->data );
+
+  if( ring_len( &p->buf ) == 0 ) {
+    return ( p->writers > 0 ) ? FILE_AGAIN : 0; // wait for a writer, or end of file
+  }
+
+  int r = ring_read( &p->buf, x, n );
+
+  wake( p ); // there is now room for blocked writers
+
+  return r;
+}
+
+static int  pipe_file_write( file_t* f, const uint8_t* x, int n ) {
+  pipe_t* p = ( pipe_t* )( f->data );
+
+  if( p->readers == 0 ) {
+    return FILE_ERROR; // nobody will ever read what is written
+  }
+  if( ( n <= RING_SIZE ) ? ( ring_free( &p->buf ) < n ) : ( ring_free( &p->buf ) == 0 ) ) {
+    return FILE_AGAIN; // wait for a reader to make room
+  }
+
+  int r = ring_write( &p->buf, x, n );
+
+  wake( p ); // there is now data for blocked readers
+
+  return r;
+}
+
+static void pipe_file_close( file_t* f ) {
+  pipe_t* p = ( pipe_t* )( f->data );
+
+  if( f->ops->read != NULL ) p->readers--;
+  else                       p->writers--;
+
+  wake( p ); // blocked readers see end of file, blocked writers fail
+}
+
+static const file_ops_t pipe_read_ops = {
+  .read  = pipe_file_read,
+  .write = NULL,
+  .mmap  = NULL,
+  .close = pipe_file_close
+};
+
+static const file_ops_t pipe_write_ops = {
+  .read  = NULL,
+  .write = pipe_file_write,
+  .mmap  = NULL,
+  .close = pipe_file_close
+};
+
+bool pipe_open( file_t** r, file_t** w ) {
+  for( int i = 0; i < MAX_PIPES; i++ ) {
+    pipe_t* p = &pipes[ i ];
+
+    if( p->readers == 0 && p->writers == 0 ) {
+      ring_init( &p->buf );
+
+      *r = file_alloc( FILE_PIPE, &pipe_read_ops,  p );
+      if( *r == NULL ) return false;
+      p->readers = 1;
+
+      *w = file_alloc( FILE_PIPE, &pipe_write_ops, p );
+      if( *w == NULL ) { file_close( *r ); return false; }
+      p->writers = 1;
+
+      return true;
+    }
+  }
+
+  return false; // If no free pipe
+}
@@ -0,0 +1,35 @@
+#ifndef __PIPE_H
+#define __PIPE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include  "file.h"
+#include  "ring.h"
+
+/* A pipe is a ring buffer with two ends, each of which is a file: bytes
+ * written to the write end can be read from the read end.  Note that
+ *
+ * - a read blocks while the pipe is empty, and returns 0 (i.e., end of
+ *   file) once it is empty *and* every write end has been closed,
+ * - a write blocks while the pipe is full, and fails once every read end
+ *   has been closed, and
+ * - a write of at most RING_SIZE bytes is atomic, so writes by different
+ *   processes are never interleaved.
+ *
+ * The pipe itself acts as wait channel for both ends.
+ */
+
+#define MAX_PIPES 8
+
+typedef struct {
+  ring_t     buf; // buffered bytes
+     int readers; // number of open read  ends
+     int writers; // number of open write ends
+} pipe_t;
+
+// allocate a pipe, with read end r and write end w; return false iff. there is no room
+extern bool pipe_open( file_t** r, file_t** w );
+
+#endif
@@ -0,0 +1,64 @@
+#include "prof.h"
+
+static prof_sample_t prof_samples[ PROF_SAMPLES ];
+static uint32_t      prof_n       = 0; // number of samples taken
+static uint32_t      prof_dropped = 0; // number of samples dropped, since buffer was full
+static spinlock_t    prof_lock    = 0; // samples are taken in hard-IRQ context, i.e., without the kernel lock
+
+void prof_sample( int pid, uint32_t pc, uint32_t lr, uint32_t cpsr ) {
+  spin_lock( &prof_lock );
+
+  if( prof_n == PROF_SAMPLES ) {
+    prof_dropped++;
+  }
+  else {
+    prof_sample_t* s = &prof_samples[ prof_n++ ];
+
+    s->pc   = pc;
+    s->lr   = lr;
+    s->pid  = pid;
+    s->mode = cpsr & 0x1F;
+    s->cpu  = cpu_id();
+  }
+
+  spin_unlock( &prof_lock );
+}
+
+bool prof_ctl( int x, uint32_t y ) {
+  if     ( x == PROF_STOP  ) {
+    TIMER1->Timer2Ctrl   = 0x00000000; // disable         timer
+  }
+  else if( x == PROF_START ) {
+    if( y != 0 && y < PROF_MIN ) return false;
+
+    TIMER1->Timer2Ctrl   = 0x00000000; // disable         timer
+    TIMER1->Timer2Load   = ( y != 0 ) ? y : PROF_PERIOD; // select period = y ticks
+    TIMER1->Timer2Ctrl   = 0x00000002; // select 32-bit   timer
+    TIMER1->Timer2Ctrl  |= 0x00000040; // select periodic timer
+    TIMER1->Timer2Ctrl  |= 0x00000020; // enable          timer interrupt
+    TIMER1->Timer2Ctrl  |= 0x00000080; // enable          timer
+  }
+  else if( x == PROF_DUMP  ) {
+    if( !dump_open() ) {
+      return false;
+    }
+
+    spin_lock( &prof_lock );
+
+    uint32_t h[ 3 ] = { PROF_MAGIC, prof_n, prof_dropped };
+
+    dump_put( h, sizeof( h ) );
+    dump_put( prof_samples, prof_n * sizeof( prof_sample_t ) );
+
+    prof_n = 0; prof_dropped = 0;
+
+    spin_unlock( &prof_lock );
+
+    dump_close();
+  }
+  else {
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,61 @@
+#ifndef __PROF_H
+#define __PROF_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "SP804.h"
+
+#include   "smp.h"
+#include  "dump.h"
+
+/* The profiler samples whatever each CPU is executing at a fixed rate,
+ * st. the functions which consume the CPU can be identified without
+ * changing the code under test.  The second timer of TIMER1 (the first
+ * being the one-shot timer, see sched.h) raises an interrupt every
+ * period cycles: CPU 0 takes it, then signals every other CPU (using
+ * SGI_PROFILE) to take a sample as well.  Each sample captures the PC and
+ * LR, the mode and the PID of the process interrupted.  Note that
+ *
+ * - samples are taken by the top half of each interrupt (see irq.h), so
+ *   the kernel is only sampled while executing the bottom half of some
+ *   other, i.e., less urgent, interrupt: elsewhere interrupts are
+ *   disabled, so kernel time shows up as the first user instruction
+ *   afterward (see stats.h to measure it), and
+ * - there are no frame pointers, so LR only approximates the caller,
+ *   i.e., it is stale within a function which has called another.
+ *
+ * Samples accumulate until the buffer is full, then are dropped (but
+ * counted); they are drained on demand as a binary dump written to
+ * DUMP_UART (see dump.h), i.e., a header of PROF_MAGIC, the number of
+ * samples and the number dropped, then the samples themselves (little-
+ * endian, per prof_sample_t).  The buffer is emptied as soon as it is
+ * copied into the dump, so sampling resumes while the dump is written.
+ * The host-side device/prof.py symbolises a dump
+ * against image.elf into folded stacks, e.g., for flamegraph.pl.
+ */
+
+#define PROF_SAMPLES ( 4096 )
+#define PROF_PERIOD  ( 1000 )       // default cycles between samples, i.e., 1 kHz
+#define PROF_MIN     (  100 )       // minimum cycles between samples, i.e., 10 kHz, st. sampling cannot starve the CPUs
+#define PROF_MAGIC   ( 0x50524631 ) // i.e., "PRF1"
+
+#define PROF_STOP    ( 0 )          // per SYS_PROF: stop  sampling
+#define PROF_START   ( 1 )          //               start sampling, every y >= PROF_MIN cycles (or PROF_PERIOD iff. y = 0)
+#define PROF_DUMP    ( 2 )          //               drain samples to DUMP_UART (shared with trace, per the magic of each dump)
+
+typedef struct {
+  uint32_t   pc;                    // PC  interrupted
+  uint32_t   lr;                    // LR  interrupted (i.e., of USR mode)
+   int16_t  pid;                    // PID interrupted, or -1 iff. idle
+   uint8_t mode;                    // mode interrupted, i.e., CPSR[ 4:0 ]
+   uint8_t  cpu;                    // CPU which took sample
+} prof_sample_t;
+
+// take sample, on this CPU, of process pid interrupted at pc with lr and cpsr
+extern void prof_sample( int pid, uint32_t pc, uint32_t lr, uint32_t cpsr );
+// start, stop or drain the profiler per x, with parameter y (e.g., a period); return false iff. invalid, or (for PROF_DUMP) a dump is still draining
+extern bool prof_ctl( int x, uint32_t y );
+
+#endif
@@ -0,0 +1,181 @@
+#include "rbtree.h"
+
+/* The implementation follows Chapter 13 of Cormen et al., "Introduction
+ * to Algorithms", except that NULL is used in place of a sentinel leaf:
+ * a NULL child is black.
+ */
+
+#define RB_RED( x ) ( ( x ) != NULL && ( x )->red )
+
+// Replace subtree rooted at x with subtree rooted at y
+static void rb_replace( rb_tree_t* t, rb_node_t* x, rb_node_t* y ) {
+  if     ( x->parent == NULL         ) t->root           = y;
+  else if( x->parent->left == x      ) x->parent->left  = y;
+  else                                 x->parent->right = y;
+
+  if( y != NULL ) y->parent = x->parent;
+}
+
+static void rb_rotate_l( rb_tree_t* t, rb_node_t* x ) {
+  rb_node_t* y = x->right;
+
+  x->right = y->left;
+  if( y->left != NULL ) y->left->parent = x;
+
+  rb_replace( t, x, y );
+
+  y->left = x; x->parent = y;
+}
+
+static void rb_rotate_r( rb_tree_t* t, rb_node_t* x ) {
+  rb_node_t* y = x->left;
+
+  x->left = y->right;
+  if( y->right != NULL ) y->right->parent = x;
+
+  rb_replace( t, x, y );
+
+  y->right = x; x->parent = y;
+}
+
+void       rb_insert( rb_tree_t* t, rb_node_t* x, bool ( *less )( rb_node_t* x, rb_node_t* y ) ) {
+  rb_node_t* p = NULL; rb_node_t** q = &t->root;
+
+  while( *q != NULL ) {
+    p = *q; q = less( x, p ) ? &p->left : &p->right;
+  }
+
+  x->parent = p; x->left = NULL; x->right = NULL; x->red = true; *q = x;
+
+  // Restore invariants, i.e., no red node has a red parent
+  while( RB_RED( x->parent ) ) {
+    rb_node_t* g = x->parent->parent;
+
+    if( x->parent == g->left ) {
+      rb_node_t* u = g->right;
+
+      if( RB_RED( u ) ) {
+        x->parent->red = false; u->red = false; g->red = true; x = g;
+        continue;
+      }
+      if( x == x->parent->right ) {
+        x = x->parent; rb_rotate_l( t, x );
+      }
+
+      x->parent->red = false; g->red = true; rb_rotate_r( t, g );
+    }
+    else {
+      rb_node_t* u = g->left;
+
+      if( RB_RED( u ) ) {
+        x->parent->red = false; u->red = false; g->red = true; x = g;
+        continue;
+      }
+      if( x == x->parent->left ) {
+        x = x->parent; rb_rotate_r( t, x );
+      }
+
+      x->parent->red = false; g->red = true; rb_rotate_l( t, g );
+    }
+  }
+
+  t->root->red = false;
+}
+
+void       rb_erase ( rb_tree_t* t, rb_node_t* z ) {
+  rb_node_t *x, *p; bool red = z->red;
+
+  // Unlink z, or its successor y iff. z has two children, noting the child x that takes its place (and parent p of x)
+  if     ( z->left  == NULL ) {
+    x = z->right; p = z->parent; rb_replace( t, z, x );
+  }
+  else if( z->right == NULL ) {
+    x = z->left;  p = z->parent; rb_replace( t, z, x );
+  }
+  else {
+    rb_node_t* y = z->right;
+
+    while( y->left != NULL ) {
+      y = y->left;
+    }
+
+    red = y->red; x = y->right;
+
+    if( y->parent == z ) {
+      p = y;
+    }
+    else {
+      p = y->parent; rb_replace( t, y, x );
+      y->right = z->right; y->right->parent = y;
+    }
+
+    rb_replace( t, z, y );
+    y->left = z->left; y->left->parent = y; y->red = z->red;
+  }
+
+  if( red ) return;
+
+  // Restore invariants, i.e., every path has the same number of black nodes
+  while( x != t->root && !RB_RED( x ) ) {
+    if( x == p->left ) {
+      rb_node_t* w = p->right;
+
+      if( RB_RED( w ) ) {
+        w->red = false; p->red = true; rb_rotate_l( t, p ); w = p->right;
+      }
+      if( !RB_RED( w->left ) && !RB_RED( w->right ) ) {
+        w->red = true; x = p; p = x->parent;
+        continue;
+      }
+      if( !RB_RED( w->right ) ) {
+        w->left->red = false; w->red = true; rb_rotate_r( t, w ); w = p->right;
+      }
+
+      w->red = p->red; p->red = false; w->right->red = false; rb_rotate_l( t, p );
+    }
+    else {
+      rb_node_t* w = p->left;
+
+      if( RB_RED( w ) ) {
+        w->red = false; p->red = true; rb_rotate_r( t, p ); w = p->left;
+      }
+      if( !RB_RED( w->left ) && !RB_RED( w->right ) ) {
+        w->red = true; x = p; p = x->parent;
+        continue;
+      }
+      if( !RB_RED( w->left ) ) {
+        w->right->red = false; w->red = true; rb_rotate_l( t, w ); w = p->left;
+      }
+
+      w->red = p->red; p->red = false; w->left->red = false; rb_rotate_r( t, p );
+    }
+
+    x = t->root;
+  }
+
+  if( x != NULL ) x->red = false;
+}
+
+rb_node_t* rb_first ( rb_tree_t* t ) {
+  rb_node_t* x = t->root;
+
+  while( x != NULL && x->left != NULL ) {
+    x = x->left;
+  }
+
+  return x;
+}
+
+rb_node_t* rb_next  ( rb_node_t* x ) {
+  if( x->right != NULL ) {
+    for( x = x->right; x->left != NULL; x = x->left );
+
+    return x;
+  }
+
+  while( x->parent != NULL && x == x->parent->right ) {
+    x = x->parent;
+  }
+
+  return x->parent;
+}
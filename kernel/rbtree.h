@@ -0,0 +1,39 @@
+#ifndef __RBTREE_H
+#define __RBTREE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* A red-black tree is a balanced binary search tree, st. insertion and
+ * removal take O( log n ) time.  The nodes are intrusive, i.e., embedded
+ * in whatever structure is being ordered: rb_entry recovers a pointer to
+ * the structure from a pointer to the node.  The ordering is defined by
+ * the less function passed to rb_insert, and equal nodes are kept in the
+ * order they were inserted.
+ */
+
+typedef struct rb_node {
+  struct rb_node* parent;
+  struct rb_node* left;
+  struct rb_node* right;
+            bool  red;
+} rb_node_t;
+
+typedef struct {
+  rb_node_t* root; // root node, or NULL iff. empty
+} rb_tree_t;
+
+#define rb_entry( x, type, member ) ( ( type* )( ( uint8_t* )( x ) - offsetof( type, member ) ) )
+
+// insert node x into tree t, after every node y st. less( x, y ) is false
+extern void       rb_insert( rb_tree_t* t, rb_node_t* x, bool ( *less )( rb_node_t* x, rb_node_t* y ) );
+// remove node x from tree t
+extern void       rb_erase ( rb_tree_t* t, rb_node_t* x );
+
+// return the first (i.e., least) node in tree t, or NULL iff. empty
+extern rb_node_t* rb_first ( rb_tree_t* t );
+// return the node after x (in order), or NULL iff. x is the last
+extern rb_node_t* rb_next  ( rb_node_t* x );
+
+#endif
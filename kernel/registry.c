@@ -0,0 +1,51 @@
+#include "registry.h"
+
+extern const program_t programs_start[], programs_end[]; // bounds of .programs section
+
+static const program_t* registry[ REGISTRY_SIZE ];
+static       uint32_t   registry_seed = 0;               // seed st. hash is perfect, or 0 iff. none was found
+
+static uint32_t registry_hash( uint32_t seed, const char* x ) {
+  uint32_t h = 0x811C9DC5 ^ seed;
+
+  while( *x != '\0' ) {
+    h ^= ( uint8_t )( *x++ ); h *= 0x01000193;
+  }
+
+  return h & ( REGISTRY_SIZE - 1 );
+}
+
+void             registry_init() {
+  int n = programs_end - programs_start;
+
+  for( uint32_t seed = 1; seed <= REGISTRY_TRIES && n <= REGISTRY_SIZE; seed++ ) {
+    bool perfect = true;
+
+    memset( registry, 0, sizeof( registry ) );
+
+    for( int i = 0; i < n && perfect; i++ ) {
+      uint32_t h = registry_hash( seed, programs_start[ i ].name );
+
+      if( registry[ h ] != NULL ) perfect = false; // collision, so try next seed
+      else                        registry[ h ] = &programs_start[ i ];
+    }
+
+    if( perfect ) {
+      registry_seed = seed; return;
+    }
+  }
+}
+
+const program_t* registry_find( const char* x ) {
+  if( registry_seed != 0 ) {
+    const program_t* p = registry[ registry_hash( registry_seed, x ) ];
+
+    return ( p != NULL && 0 == strcmp( p->name, x ) ) ? p : NULL;
+  }
+
+  for( const program_t* p = programs_start; p < programs_end; p++ ) {
+    if( 0 == strcmp( p->name, x ) ) return p;
+  }
+
+  return NULL;
+}
@@ -0,0 +1,37 @@
+#ifndef __REGISTRY_H
+#define __REGISTRY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string.h>
+
+/* Each program linked into the kernel registers itself via a record (see
+ * PROGRAM in libc.h), which the linker collects into the .programs
+ * section: exec can then find a program by name, along with the stack
+ * size it needs and its default base priority.
+ *
+ * The records are indexed by a hash table, using a (seeded) FNV-1a hash
+ * function: on initialisation, a seed is searched for st. the hash is
+ * perfect wrt. the registered names.  A lookup then needs exactly one
+ * probe and one string comparison.  If no such seed is found (e.g., if
+ * there are too many programs), lookup falls back to a linear search.
+ */
+
+#define REGISTRY_SIZE  (   32 ) // number of slots in hash table, which must be a power of two
+#define REGISTRY_TRIES ( 4096 ) // number of seeds to try before giving up
+
+typedef struct {
+  const char*     name;         // name, as passed to exec
+       void ( *entry )();       // entry point
+   uint32_t      stack;         // stack size required
+        int   priority;         // default base priority
+} program_t;
+
+// build hash table wrt. programs in .programs section
+extern void             registry_init();
+// find program named x; return NULL iff. there is none
+extern const program_t* registry_find( const char* x );
+
+#endif
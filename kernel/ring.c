@@ -0,0 +1,34 @@
+#include "ring.h"
+
+void     ring_init( ring_t* r ) {
+  r->head = 0;
+  r->tail = 0;
+}
+
+uint32_t ring_len ( ring_t* r ) {
+  return r->head - r->tail;
+}
+
+uint32_t ring_free( ring_t* r ) {
+  return RING_SIZE - ( r->head - r->tail );
+}
+
+int      ring_write( ring_t* r, const uint8_t* x, int n ) {
+  int i;
+
+  for( i = 0; ( i < n ) && ( ring_free( r ) > 0 ); i++ ) {
+    r->data[ r->head++ & ( RING_SIZE - 1 ) ] = x[ i ];
+  }
+
+  return i;
+}
+
+int      ring_read ( ring_t* r,       uint8_t* x, int n ) {
+  int i;
+
+  for( i = 0; ( i < n ) && ( ring_len ( r ) > 0 ); i++ ) {
+    x[ i ] = r->data[ r->tail++ & ( RING_SIZE - 1 ) ];
+  }
+
+  return i;
+}
@@ -0,0 +1,39 @@
+#ifndef __RING_H
+#define __RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* A ring (or circular) buffer of bytes, as used to decouple a producer
+ * from a consumer (e.g., a process writing to a UART from the interrupt
+ * handler that actually transmits the bytes).  Note that
+ *
+ * - the head and tail are free-running counters, and are only reduced
+ *   modulo the capacity when used as an index: this means the buffer is
+ *   empty iff. head = tail, and full iff. head - tail = RING_SIZE, and
+ * - RING_SIZE must therefore be a power of two.
+ */
+
+#define RING_SIZE ( 256 )
+
+typedef struct {
+   uint8_t data[ RING_SIZE ]; // buffered bytes
+  uint32_t head;              // number of bytes ever written
+  uint32_t tail;              // number of bytes ever read
+} ring_t;
+
+// initialise ring r st. it is empty
+extern void     ring_init( ring_t* r );
+
+// return number of bytes queued in ring r
+extern uint32_t ring_len ( ring_t* r );
+// return number of bytes free   in ring r
+extern uint32_t ring_free( ring_t* r );
+
+// queue   up to n bytes from x into ring r; return bytes queued
+extern int      ring_write( ring_t* r, const uint8_t* x, int n );
+// dequeue up to n bytes into x from ring r; return bytes dequeued
+extern int      ring_read ( ring_t* r,       uint8_t* x, int n );
+
+#endif
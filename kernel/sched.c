@@ -0,0 +1,565 @@
+#include "sched.h"
+#include "hilevel.h"
+
+extern cpu_t cpus[ MAX_CPUS ];
+
+static rq_t rqs[ MAX_CPUS ];
+
+static uint32_t sched_quanta[ SCHED_CLASSES ] = { // quantum per class, see sched.h
+  [ SCHED_FAIR ] = SLICE_FAIR,
+  [ SCHED_PRIO ] = SLICE_PRIO,
+  [ SCHED_EDF  ] = 0
+};
+
+// -------------------------------------------------------------------------------------------------------------------
+// SCHED_PRIO
+
+static void   prio_enqueue( rq_t* rq, pcb_t* p ) {
+  return;
+}
+
+static void   prio_dequeue( rq_t* rq, pcb_t* p ) {
+  return;
+}
+
+static pcb_t* prio_pick   ( rq_t* rq ) {
+  pcb_t* r = NULL; int max_priority = 0;
+
+  // Find process with highest priority, i.e., base priority + age
+  for( pcb_t* p = rq->head; p != NULL; p = p->rq_next ) {
+    int priority = p->b_priority + p->age;
+
+    if( p->policy == SCHED_PRIO && ( r == NULL || max_priority <= priority ) ) {
+      r = p; max_priority = priority;
+    }
+  }
+
+  // Increment age of other processes in the class
+  for( pcb_t* p = rq->head; p != NULL; p = p->rq_next ) {
+    if( p->policy != SCHED_PRIO ) continue;
+
+    if( p != r ) p->age++;
+    else         p->age = 0;
+  }
+
+  return r;
+}
+
+static void   prio_charge ( rq_t* rq, pcb_t* p, uint32_t t ) {
+  return;
+}
+
+// A process with higher base priority executes for longer once picked, i.e., the quantum per unit of base priority
+static uint32_t prio_slice( rq_t* rq, pcb_t* p ) {
+  uint64_t r = ( uint64_t )( sched_quanta[ SCHED_PRIO ] ) * ( ( p->b_priority < 1 ) ? 1 : p->b_priority );
+
+  return ( r > SLICE_MAX ) ? SLICE_MAX : r;
+}
+
+static const sched_class_t sched_prio = { prio_enqueue, prio_dequeue, prio_pick, prio_charge, prio_slice };
+
+// -------------------------------------------------------------------------------------------------------------------
+// SCHED_FAIR
+
+/* Weight per base priority, from -FAIR_OFFSET (i.e., the lowest weight)
+ * up, st. the default base priority of 1 has weight 1024; any priority
+ * outside the table has the nearest weight in it.  Each weight is ~1.25
+ * times the previous, st. a process with base priority one higher than
+ * another gets ~10% more of the CPU.  Rather than divide by the weight
+ * whenever a process is charged, multiply by 2^32 / weight then shift.
+ */
+
+#define FAIR_WEIGHTS ( 40 )
+#define FAIR_OFFSET  ( 18 )
+
+static const uint32_t fair_weights[ FAIR_WEIGHTS ] = {
+     15,    18,    23,    29,    36,    45,    56,    70,    87,   110,
+    137,   172,   215,   272,   335,   423,   526,   655,   820,  1024,
+   1277,  1586,  1991,  2501,  3121,  3906,  4904,  6100,  7620,  9548,
+  11916, 14949, 18705, 23254, 29154, 36291, 46273, 56483, 71755, 88761
+};
+
+static       uint32_t fair_inverse[ FAIR_WEIGHTS ];
+
+static int    fair_index  ( pcb_t* p ) {
+  int i = p->b_priority + FAIR_OFFSET;
+
+  return ( i < 0 ) ? 0 : ( i >= FAIR_WEIGHTS ) ? ( FAIR_WEIGHTS - 1 ) : i;
+}
+
+static bool   fair_less   ( rb_node_t* x, rb_node_t* y ) {
+  return rb_entry( x, pcb_t, rb )->vruntime < rb_entry( y, pcb_t, rb )->vruntime;
+}
+
+static void   fair_enqueue( rq_t* rq, pcb_t* p ) {
+  // A process that was waiting (or new) starts no earlier than the least virtual runtime, st. it cannot monopolise the CPU
+  if( p->vruntime < rq->fair_min ) p->vruntime = rq->fair_min;
+
+  rb_insert( &rq->fair, &p->rb, &fair_less );
+
+  p->weight = fair_weights[ fair_index( p ) ]; rq->fair_weight += p->weight; // as of now, st. nice while queued cannot skew the sum
+}
+
+static void   fair_dequeue( rq_t* rq, pcb_t* p ) {
+  rb_erase( &rq->fair, &p->rb );
+
+  rq->fair_weight -= p->weight;
+}
+
+static pcb_t* fair_pick   ( rq_t* rq ) {
+  rb_node_t* x = rb_first( &rq->fair );
+
+  if( x == NULL ) return NULL;
+
+  pcb_t* r = rb_entry( x, pcb_t, rb );
+
+  if( r->vruntime > rq->fair_min ) rq->fair_min = r->vruntime;
+
+  return r;
+}
+
+static void   fair_charge ( rq_t* rq, pcb_t* p, uint32_t t ) {
+  p->vruntime += ( ( uint64_t )( t ) * fair_inverse[ fair_index( p ) ] ) >> 22; // i.e., t * 1024 / weight
+}
+
+// Each process ready (or executing) executes once per quantum, for a share of it proportional to its weight
+static uint32_t fair_slice( rq_t* rq, pcb_t* p ) {
+  uint32_t w = fair_weights[ fair_index( p ) ];
+
+  uint32_t r = ( ( uint64_t )( sched_quanta[ SCHED_FAIR ] ) * w ) / ( rq->fair_weight + w );
+
+  return ( r < SLICE_MIN ) ? SLICE_MIN : r;
+}
+
+static const sched_class_t sched_fair = { fair_enqueue, fair_dequeue, fair_pick, fair_charge, fair_slice };
+
+// -------------------------------------------------------------------------------------------------------------------
+// SCHED_EDF
+
+/* Each process in the class has a runtime, a (relative) deadline and a
+ * period: it is guaranteed to execute for runtime cycles within deadline
+ * cycles of the start of each period, as long as the utilisation (i.e.,
+ * the sum of runtime / period, per CPU) is at most EDF_BOUND / 1024.  To
+ * make that guarantee, each such process is
+ *
+ * - admitted onto (and then pinned to) a CPU iff. doing so keeps it
+ *   within the bound,
+ * - picked in order of absolute deadline (i.e., Earliest Deadline First
+ *   (EDF)), before any process in another class, and preempts them once
+ *   it is ready, and
+ * - throttled once it has executed for its runtime (i.e., exhausted its
+ *   budget) until the next period, st. it cannot overrun and so cause
+ *   another to miss its deadline.  A one-shot timer is programmed on
+ *   dispatch to expire once the budget is exhausted.
+ *
+ * A process that waits (e.g., for I/O) keeps its deadline once woken iff.
+ * the remaining budget can be used before it without exceeding the
+ * reserved utilisation, or otherwise starts a new period (per the
+ * Constant Bandwidth Server (CBS) algorithm), st. waking late cannot be
+ * used to execute for more than reserved.
+ */
+
+#define EDF_BOUND      ( 960        ) // utilisation bound per CPU, i.e., ~94%
+#define EDF_MAX_PERIOD ( 0x00400000 ) // maximum period, st. runtime << 10 never overflows
+
+#define EDF_BEFORE( x, y ) ( ( int32_t )( ( x ) - ( y ) ) < 0 ) // time x is before time y, modulo wrapping
+
+static bool   edf_less    ( rb_node_t* x, rb_node_t* y ) {
+  return EDF_BEFORE( rb_entry( x, pcb_t, rb )->dl_abs, rb_entry( y, pcb_t, rb )->dl_abs );
+}
+
+static void   edf_enqueue ( rq_t* rq, pcb_t* p ) {
+  uint32_t t = clock_now();
+
+  if( p->dl_throttled ) {
+    rq->edf_throttled++; return;
+  }
+
+  // Start a new period iff. the deadline has passed, or the remaining budget can't be used before it at the reserved utilisation
+  if( !EDF_BEFORE( t, p->dl_abs ) || ( ( uint64_t )( p->dl_budget ) * p->dl_period ) > ( ( uint64_t )( p->dl_abs - t ) * p->dl_runtime ) ) {
+    p->dl_abs = t + p->dl_deadline; p->dl_budget = p->dl_runtime;
+  }
+
+  rb_insert( &rq->edf, &p->rb, &edf_less );
+}
+
+static void   edf_dequeue ( rq_t* rq, pcb_t* p ) {
+  if( p->dl_throttled ) {
+    rq->edf_throttled--; return;
+  }
+
+  rb_erase( &rq->edf, &p->rb );
+}
+
+// Replenish the budget of each throttled process whose next period has started
+static void   edf_replenish( rq_t* rq ) {
+  uint32_t t = clock_now();
+
+  for( pcb_t* p = rq->head; p != NULL && rq->edf_throttled > 0; p = p->rq_next ) {
+    if( p->policy == SCHED_EDF && p->dl_throttled && !EDF_BEFORE( t, p->dl_replenish ) ) {
+      rq->edf_throttled--; p->dl_throttled = false;
+
+      p->dl_abs = p->dl_replenish + p->dl_deadline; p->dl_budget = p->dl_runtime;
+
+      rb_insert( &rq->edf, &p->rb, &edf_less );
+    }
+  }
+}
+
+static pcb_t* edf_pick    ( rq_t* rq ) {
+  if( rq->edf_throttled > 0 ) edf_replenish( rq );
+
+  rb_node_t* x = rb_first( &rq->edf );
+
+  return ( x != NULL ) ? rb_entry( x, pcb_t, rb ) : NULL;
+}
+
+static void   edf_charge  ( rq_t* rq, pcb_t* p, uint32_t t ) {
+  if( t < p->dl_budget ) {
+    p->dl_budget -= t; return;
+  }
+
+  // Budget exhausted, so throttle until the next period
+  p->dl_budget    = 0;
+  p->dl_throttled = true;
+  p->dl_replenish = p->dl_abs - p->dl_deadline + p->dl_period;
+}
+
+// A process executes until preempted by an earlier deadline, or its budget is exhausted
+static uint32_t edf_slice ( rq_t* rq, pcb_t* p ) {
+  return p->dl_budget;
+}
+
+static const sched_class_t sched_edf  = { edf_enqueue, edf_dequeue, edf_pick, edf_charge, edf_slice };
+
+// Release the utilisation reserved for process p (iff. any)
+static void   edf_release ( pcb_t* p ) {
+  if( p->policy == SCHED_EDF ) {
+    rqs[ p->dl_cpu ].edf_util -= p->dl_util; p->dl_util = 0;
+  }
+}
+
+// -------------------------------------------------------------------------------------------------------------------
+// Classes
+
+static const sched_class_t* sched_classes[ SCHED_CLASSES ] = {
+  [ SCHED_FAIR ] = &sched_fair,
+  [ SCHED_PRIO ] = &sched_prio,
+  [ SCHED_EDF  ] = &sched_edf
+};
+
+static const sched_class_t* sched_order  [ SCHED_CLASSES ] = { // i.e., in order of precedence
+  &sched_edf,
+  &sched_prio,
+  &sched_fair
+};
+
+void   sched_init() {
+  for( int i = 0; i < FAIR_WEIGHTS; i++ ) {
+    fair_inverse[ i ] = 0xFFFFFFFF / fair_weights[ i ];
+  }
+
+  clock_init();
+}
+
+bool   sched_class  ( pcb_t* p, int x ) {
+  if( x < 0 || x >= SCHED_CLASSES || x == SCHED_EDF ) return false; // SCHED_EDF needs parameters, i.e., sched_admit
+
+  bool queued = p->queued; int c = p->cpu;
+
+  if( queued ) rq_remove( p );
+  edf_release( p );
+  p->policy = x;
+  if( queued ) rq_push( c, p );
+
+  return true;
+}
+
+bool   sched_admit  ( pcb_t* p, sched_attr_t* x ) {
+  if( x->policy != SCHED_EDF ) {
+    if( x->slice != 0 && ( x->slice < SLICE_MIN || x->slice > SLICE_MAX ) ) return false;
+    if( !sched_class( p, x->policy ) ) return false;
+
+    p->b_priority = x->priority;
+
+    return sched_slice( p, x->slice );
+  }
+
+  if( x->runtime == 0 || x->runtime > x->deadline || x->deadline > x->period || x->period > EDF_MAX_PERIOD ) {
+    return false;
+  }
+
+  uint32_t u = ( x->runtime << 10 ) / x->period, v[ MAX_CPUS ]; int c = -1;
+
+  // Admit onto the CPU the process is on iff. there is room (discounting whatever it has reserved already), or else whichever online CPU has most room
+  for( int d = 0; d < MAX_CPUS; d++ ) {
+    v[ d ] = rqs[ d ].edf_util - ( ( p->policy == SCHED_EDF && p->dl_cpu == d ) ? p->dl_util : 0 );
+
+    if( cpus[ d ].current == NULL || ( v[ d ] + u ) > EDF_BOUND ) continue;
+
+    if( c == -1 || d == p->cpu || ( c != p->cpu && v[ d ] < v[ c ] ) ) c = d;
+  }
+
+  if( c == -1 ) return false;
+
+  bool queued = p->queued;
+
+  if( queued ) rq_remove( p );
+  edf_release( p );
+
+  rqs[ c ].edf_util += u;
+
+  p->policy       = SCHED_EDF;
+  p->dl_cpu       = c;
+  p->dl_util      = u;
+  p->dl_runtime   = x->runtime;
+  p->dl_deadline  = x->deadline;
+  p->dl_period    = x->period;
+  p->dl_abs       = clock_now() + x->deadline; // i.e., start a new period
+  p->dl_budget    = x->runtime;
+  p->dl_throttled = false;
+
+  if( queued ) rq_push( c, p );
+
+  return true;
+}
+
+bool   sched_slice( pcb_t* p, uint32_t x ) {
+  if( x != 0 && ( x < SLICE_MIN || x > SLICE_MAX ) ) return false;
+
+  p->slice = x;
+
+  return true;
+}
+
+bool   sched_quantum( int c, uint32_t x ) {
+  if( c < 0 || c >= SCHED_CLASSES || c == SCHED_EDF || x < SLICE_MIN || x > SLICE_MAX ) return false; // SCHED_EDF has a budget instead
+
+  sched_quanta[ c ] = x;
+
+  return true;
+}
+
+void   sched_exit   ( pcb_t* p ) {
+  edf_release( p );
+}
+
+// -------------------------------------------------------------------------------------------------------------------
+// Runqueues
+
+void   rq_push   ( int c, pcb_t* p ) {
+  if( p->policy == SCHED_EDF ) c = p->dl_cpu; // pinned to whichever CPU admitted it
+
+  pcb_t** q = &rqs[ c ].head;
+
+  while( *q != NULL ) { // append, st. processes of equal priority are picked in order
+    q = &( *q )->rq_next;
+  }
+
+  *q = p; p->rq_next = NULL; p->cpu = c; p->queued = true; p->enqueued = clock_now();
+
+  sched_classes[ p->policy ]->enqueue( &rqs[ c ], p );
+
+  rqs[ c ].n++;
+}
+
+void   rq_remove ( pcb_t* p ) {
+  if( !p->queued ) return;
+
+  for( pcb_t** q = &rqs[ p->cpu ].head; *q != NULL; q = &( *q )->rq_next ) {
+    if( *q == p ) {
+      *q = p->rq_next; p->rq_next = NULL; p->queued = false;
+
+      sched_classes[ p->policy ]->dequeue( &rqs[ p->cpu ], p );
+
+      rqs[ p->cpu ].n--; break;
+    }
+  }
+}
+
+pcb_t* rq_pick   ( int c ) {
+  pcb_t* r = NULL;
+
+  for( int i = 0; i < SCHED_CLASSES && r == NULL; i++ ) {
+    r = sched_order[ i ]->pick( &rqs[ c ] );
+  }
+
+  if( r != NULL ) rq_remove( r );
+
+  return r;
+}
+
+void   rq_charge ( int c, pcb_t* p ) {
+  uint32_t t = clock_now() - rqs[ c ].stamp;
+
+  rqs[ c ].stamp += t;
+
+  if( p != NULL && p != &cpus[ c ].idle_pcb ) {
+    sched_classes[ p->policy ]->charge( &rqs[ c ], p, t );
+  }
+}
+
+int    rq_load   ( int c ) {
+  return rqs[ c ].n + ( ( cpus[ c ].current != NULL && cpus[ c ].current != &cpus[ c ].idle_pcb ) ? 1 : 0 );
+}
+
+int    rq_place  ( int c ) {
+  int r = c;
+
+  for( int d = 0; d < MAX_CPUS; d++ ) {
+    if( cpus[ d ].current != NULL && rq_load( d ) < rq_load( r ) ) r = d; // only online CPUs
+  }
+
+  return r;
+}
+
+bool   rq_preempt( int c ) {
+  pcb_t* p = cpus[ c ].current; rq_t* rq = &rqs[ c ];
+
+  if( p == &cpus[ c ].idle_pcb ) {
+    return rq_ready( c );
+  }
+  if( rq->edf_throttled > 0 ) {
+    edf_replenish( rq );
+  }
+
+  rb_node_t* x = rb_first( &rq->edf );
+
+  return x != NULL && ( p->policy != SCHED_EDF || EDF_BEFORE( rb_entry( x, pcb_t, rb )->dl_abs, p->dl_abs ) );
+}
+
+// Program the one-shot timer to expire at the earliest expiry armed by any CPU, or disable it iff. there is none
+static void rq_timer() {
+  uint32_t t = clock_now(), d = 0; bool armed = false;
+
+  for( int c = 0; c < MAX_CPUS; c++ ) {
+    uint32_t e = EDF_BEFORE( t, rqs[ c ].expiry ) ? rqs[ c ].expiry - t : 1; // i.e., immediately iff. passed already
+
+    if( rqs[ c ].armed && ( !armed || e < d ) ) {
+      d = e; armed = true;
+    }
+  }
+
+  TIMER1->Timer1Ctrl   = 0x00000000; // disable         timer
+
+  if( armed ) {
+    TIMER1->Timer1Load = d;          // select period = d ticks
+    TIMER1->Timer1Ctrl = 0x000000A3; // select one-shot 32-bit timer, enable timer interrupt, enable timer
+  }
+}
+
+void   rq_arm    ( int c, pcb_t* p ) {
+  rq_t* rq = &rqs[ c ]; uint32_t t = clock_now();
+
+  rq->armed = false;
+
+  // Expire once the time slice of the process ends (i.e., its budget is exhausted iff. it is in SCHED_EDF) ...
+  if( p != NULL && p != &cpus[ c ].idle_pcb ) {
+    uint32_t x = ( p->slice != 0 && p->policy != SCHED_EDF ) ? p->slice : sched_classes[ p->policy ]->slice( rq, p );
+
+    rq->armed = true; rq->expiry = t + x;
+  }
+
+  // ... or once the budget of a throttled process is replenished, iff. earlier
+  for( pcb_t* q = rq->head; q != NULL && rq->edf_throttled > 0; q = q->rq_next ) {
+    if( q->policy == SCHED_EDF && q->dl_throttled && ( !rq->armed || EDF_BEFORE( q->dl_replenish, rq->expiry ) ) ) {
+      rq->armed = true; rq->expiry = q->dl_replenish;
+    }
+  }
+
+  rq_timer();
+}
+
+bool   rq_expired( int c ) {
+  uint32_t t = clock_now(); bool r = false;
+
+  for( int d = 0; d < MAX_CPUS; d++ ) {
+    if( rqs[ d ].armed && !EDF_BEFORE( t, rqs[ d ].expiry ) ) {
+      rqs[ d ].armed = false;
+
+      if( d == c ) r = true; else smp_signal( d );
+    }
+  }
+
+  rq_timer();
+
+  return r;
+}
+
+// Process p is pinned to the runqueue it is on iff. in SCHED_EDF, since it was admitted onto that CPU alone
+static bool rq_pinned ( pcb_t* p ) {
+  return p->policy == SCHED_EDF;
+}
+
+// Return number of processes on the runqueue of CPU d which another CPU could steal, i.e., which are not pinned
+static int  rq_movable( int d ) {
+  int n = 0;
+
+  for( pcb_t* p = rqs[ d ].head; p != NULL; p = p->rq_next ) {
+    if( !rq_pinned( p ) ) n++;
+  }
+
+  return n;
+}
+
+bool   rq_ready  ( int c ) {
+  // A throttled process (in SCHED_EDF) cannot be picked until replenished, ...
+  if( ( rqs[ c ].n - rqs[ c ].edf_throttled ) > 0 ) return true;
+
+  // ... nor can one on another runqueue be stolen iff. it is pinned
+  for( int d = 0; d < MAX_CPUS; d++ ) {
+    if( d != c && rq_movable( d ) > 0 ) return true;
+  }
+
+  return false;
+}
+
+// Move whichever process on the runqueue of CPU d has waited longest to that of CPU c, other than those pinned
+static bool rq_move( int d, int c ) {
+  pcb_t* r = NULL; uint32_t t = clock_now();
+
+  for( pcb_t* p = rqs[ d ].head; p != NULL; p = p->rq_next ) {
+    if( !rq_pinned( p ) && ( r == NULL || ( t - p->enqueued ) > ( t - r->enqueued ) ) ) r = p;
+  }
+
+  if( r == NULL ) return false;
+
+  rq_remove( r );
+
+  // Virtual runtime is relative to the runqueue, so preserve its position relative to the least
+  r->vruntime += rqs[ c ].fair_min - rqs[ d ].fair_min;
+
+  rq_push( c, r );
+
+  return true;
+}
+
+bool   rq_steal  ( int c ) {
+  int d = -1, n = 0;
+
+  // Steal from whichever runqueue has most processes which can be, rather than most processes (some of which may be pinned)
+  for( int e = 0; e < MAX_CPUS; e++ ) {
+    int m = ( e != c ) ? rq_movable( e ) : 0;
+
+    if( m > n ) {
+      d = e; n = m;
+    }
+  }
+
+  return d != -1 && rq_move( d, c );
+}
+
+void   rq_balance() {
+  int hi = -1, lo = -1;
+
+  for( int c = 0; c < MAX_CPUS; c++ ) {
+    if( cpus[ c ].current == NULL ) continue; // only online CPUs
+
+    if( hi == -1 || rq_load( c ) > rq_load( hi ) ) hi = c;
+    if( lo == -1 || rq_load( c ) < rq_load( lo ) ) lo = c;
+  }
+
+  if( hi != -1 && rqs[ hi ].n > 0 && ( rq_load( hi ) - rq_load( lo ) ) > 1 ) {
+    rq_move( hi, lo );
+  }
+}
@@ -0,0 +1,156 @@
+#ifndef __SCHED_H
+#define __SCHED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include     "smp.h"
+#include  "rbtree.h"
+#include   "clock.h"
+
+/* Each CPU has a runqueue of the processes which are ready to execute on
+ * it, i.e., which are runnable but not executing: scheduling then only
+ * considers the runqueue of the CPU doing so, rather than every process
+ * in the process table, st. the cost depends on how many processes each
+ * CPU has rather than on how many CPUs there are.  Note that
+ *
+ * - a process stays on the runqueue of whichever CPU it last executed on
+ *   (e.g., once woken), since that CPU is the one likely to have whatever
+ *   it last accessed cached,
+ * - a CPU whose runqueue is empty steals from the longest runqueue of
+ *   another CPU, rather than execute its idle process, and
+ * - the runqueues are periodically rebalanced, st. the load (i.e., the
+ *   number of processes on, or executing on, a CPU) differs by at most
+ *   one between CPUs.
+ *
+ * Whenever a process is moved between runqueues, whichever has waited
+ * longest is moved: its cache footprint has most likely been evicted
+ * already, so it loses least from the move.
+ *
+ * Each process belongs to a scheduling class, which decides the order
+ * processes of that class are picked in; the classes themselves have a
+ * fixed precedence, st. a process is only picked iff. no process of a
+ * class with higher precedence is on the runqueue.  In order of
+ * precedence, the classes are
+ *
+ * - SCHED_EDF, which picks the process with the earliest deadline, and
+ *   guarantees each process executes for a given runtime within a given
+ *   deadline each period (see sched.c), iff. it was admitted,
+ * - SCHED_PRIO, which picks the process with highest priority, i.e.,
+ *   base priority plus age (the time spent waiting since last executed),
+ *   and
+ * - SCHED_FAIR, the default, which picks the process with least virtual
+ *   runtime, i.e., time spent executing (measured in clock cycles, see
+ *   clock.h) scaled by the inverse of a weight.  The base priority (as
+ *   set by nice) selects the weight: each increment multiplies it by
+ *   ~1.25, st. each process gets a share of the CPU proportional to its
+ *   weight.  The runqueue keeps processes of the class in a red-black
+ *   tree ordered by virtual runtime.
+ *
+ * Once dispatched, a process executes until it waits, is preempted or its
+ * time slice ends: a one-shot timer is programmed on each dispatch to
+ * expire once it does.  Each class computes the time slice from its
+ * quantum (which can be set at runtime, per class), unless a process has
+ * a time slice of its own (e.g., a long one for batch processing):
+ *
+ * - SCHED_EDF uses the remaining budget,
+ * - SCHED_PRIO uses the quantum times the base priority, and
+ * - SCHED_FAIR divides the quantum between processes on the runqueue in
+ *   proportion to weight, st. each executes once per quantum: a process
+ *   gets short time slices (i.e., responds quickly) once many contend for
+ *   the CPU, and long ones (i.e., fewer context switches) otherwise.
+ *
+ * Each runqueue is a list, linked via the PCBs it includes, in addition
+ * to whatever structure each class maintains; it is only accessed while
+ * the kernel lock is held.
+ */
+
+#define RQ_BALANCE    ( 0x00040000 ) // cycles between rebalancing, i.e., timer period
+
+#define SLICE_MIN     (    1000 ) // minimum time slice, in cycles (i.e.,  1 ms)
+#define SLICE_MAX     ( 1000000 ) // maximum time slice, in cycles (i.e.,  1 s)
+#define SLICE_FAIR    (   20000 ) // default SCHED_FAIR quantum    (i.e., 20 ms)
+#define SLICE_PRIO    (   10000 ) // default SCHED_PRIO quantum    (i.e., 10 ms)
+
+#define SCHED_FAIR    ( 0 ) // weighted fair-share class
+#define SCHED_PRIO    ( 1 ) //    priority+age  class
+#define SCHED_EDF     ( 2 ) // earliest deadline first class
+#define SCHED_CLASSES ( 3 )
+
+typedef struct pcb pcb_t;
+
+typedef struct {
+     pcb_t* head;     // first process on runqueue, or NULL iff. empty
+       int  n;        // number of processes on runqueue
+  uint32_t  stamp;    // time executing process was last charged, i.e., dispatched
+
+  rb_tree_t fair;        // SCHED_FAIR: processes, ordered by virtual runtime
+  uint64_t  fair_min;    // SCHED_FAIR: least virtual runtime so far, which never decreases
+  uint32_t  fair_weight; // SCHED_FAIR: sum of weights of processes
+
+  rb_tree_t edf;           // SCHED_EDF: processes (other than throttled ones), ordered by absolute deadline
+       int  edf_throttled; // SCHED_EDF: number of throttled processes
+  uint32_t  edf_util;      // SCHED_EDF: utilisation reserved by processes admitted onto CPU, in 1024ths
+
+      bool  armed;    // one-shot timer is armed wrt. CPU
+  uint32_t  expiry;   // time one-shot timer expires wrt. CPU iff. armed
+} rq_t;
+
+typedef struct {
+       int  policy;   // scheduling class
+       int  priority; // base priority, iff. not SCHED_EDF
+  uint32_t  runtime;  // SCHED_EDF: runtime  per period, in cycles
+  uint32_t  deadline; // SCHED_EDF: deadline relative to start of period, in cycles
+  uint32_t  period;   // SCHED_EDF: period, in cycles
+  uint32_t  slice;    // time slice, in cycles, or 0 iff. per class, iff. not SCHED_EDF
+} sched_attr_t;
+
+typedef struct {
+  void     ( *enqueue )( rq_t* rq, pcb_t* p );             // add    process p
+  void     ( *dequeue )( rq_t* rq, pcb_t* p );             // remove process p
+  pcb_t*   ( *pick    )( rq_t* rq );                       // return process to execute next (without removing it), or NULL iff. none
+  void     ( *charge  )( rq_t* rq, pcb_t* p, uint32_t t ); // account for process p executing for t cycles
+  uint32_t ( *slice   )( rq_t* rq, pcb_t* p );             // return time slice of process p, in cycles, once dispatched
+} sched_class_t;
+
+// initialise scheduling classes (and clock)
+extern void   sched_init();
+// move process p into scheduling class x; return false iff. x is invalid
+extern bool   sched_class  ( pcb_t* p, int x );
+// move process p into scheduling class (with parameters) per x; return false iff. x is invalid, or p cannot be admitted
+extern bool   sched_admit  ( pcb_t* p, sched_attr_t* x );
+// set time slice of process p to x cycles, or per class iff. x = 0; return false iff. x is invalid
+extern bool   sched_slice  ( pcb_t* p, uint32_t x );
+// set quantum of scheduling class c to x cycles; return false iff. c or x is invalid
+extern bool   sched_quantum( int c, uint32_t x );
+// release whatever process p reserved, once it terminates
+extern void   sched_exit   ( pcb_t* p );
+
+// add process p to the runqueue of CPU c
+extern void   rq_push   ( int c, pcb_t* p );
+// remove process p from whichever runqueue it is on (iff. any)
+extern void   rq_remove ( pcb_t* p );
+// remove (and return) the process to execute next from the runqueue of CPU c; return NULL iff. empty
+extern pcb_t* rq_pick   ( int c );
+// account for process p executing on CPU c since it was dispatched
+extern void   rq_charge ( int c, pcb_t* p );
+// arm one-shot timer wrt. CPU c, having dispatched process p, st. it expires once the time slice of p ends
+extern void   rq_arm    ( int c, pcb_t* p );
+// disarm one-shot timer wrt. each CPU it has expired for, signalling other CPUs to reschedule; return true iff. CPU c should
+extern bool   rq_expired( int c );
+// return true iff. CPU c should preempt whatever it is executing, i.e., is idle while a process is ready, or has a process ready in SCHED_EDF
+extern bool   rq_preempt( int c );
+
+// return the number of processes on, or executing on, CPU c
+extern int    rq_load   ( int c );
+// return the CPU to add a new process to, i.e., the least loaded (preferring CPU c)
+extern int    rq_place  ( int c );
+// return true iff. CPU c has, or could steal, a process to execute
+extern bool   rq_ready  ( int c );
+// move a process from the longest runqueue of another CPU to that of CPU c; return false iff. there is none
+extern bool   rq_steal  ( int c );
+// move a process from the most to the least loaded CPU iff. they differ by more than one
+extern void   rq_balance();
+
+#endif
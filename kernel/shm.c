@@ -0,0 +1,63 @@
+#include "shm.h"
+
+extern uint32_t tos_procs; // Limit of shared memory area
+
+region regions[ MAX_SHM ] = { 0 };
+
+uint32_t shm_bottom = 0; // bottom of lowest region carved out so far
+
+// Find an unoccupied region able to hold n bytes, carving out a new one iff. none can be reused
+region* get_free_region( uint32_t n ) {
+  for( int i = 0; i < MAX_SHM; i++ ) {
+    if( regions[ i ].state == UNOCCUPIED && regions[ i ].size >= n ) return &regions[ i ];
+  }
+
+  if( shm_bottom == 0 ) {
+    shm_bottom = ( uint32_t )( &shm );
+  }
+
+  n = ( n + 7 ) & ~7; // keep regions 8-byte aligned
+
+  for( int i = 0; i < MAX_SHM; i++ ) {
+    if( regions[ i ].state == UNOCCUPIED && regions[ i ].size == 0 ) {
+      if( ( shm_bottom - ( uint32_t )( &tos_procs ) ) < n ) break;
+
+      shm_bottom        -= n;
+      regions[ i ].offset = shm_bottom;
+      regions[ i ].size   = n;
+
+      return &regions[ i ];
+    }
+  }
+
+  return NULL; // If no free shm left
+}
+
+static void* shm_file_mmap ( file_t* f ) {
+  return ( void* )( ( ( region* )( f->data ) )->offset );
+}
+
+static void  shm_file_close( file_t* f ) {
+  ( ( region* )( f->data ) )->state = UNOCCUPIED;
+}
+
+static const file_ops_t shm_ops = {
+  .read  = NULL,
+  .write = NULL,
+  .mmap  = shm_file_mmap,
+  .close = shm_file_close
+};
+
+file_t* shm_file( uint32_t n ) {
+  region* r = get_free_region( n );
+  if( r == NULL ) return NULL;
+
+  file_t* f = file_alloc( FILE_SHM, &shm_ops, r );
+  if( f == NULL ) return NULL;
+
+  // Set attributes and shared memory region
+  r->state = OCCUPIED;
+  mem_zero( ( void* )( r->offset ), r->size );
+
+  return f;
+}
@@ -0,0 +1,38 @@
+#ifndef __SHM_H
+#define __SHM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string.h>
+
+#include  "file.h"
+#include   "mem.h"
+
+/* Shared memory regions are carved out of a fixed area of memory, which
+ * extends downward from the address shm.  A region is released once the
+ * last file descriptor referring to it is closed; a region that has been
+ * released may then be reused by any later request of the same or smaller
+ * size.
+ */
+
+extern uint32_t shm; // Address to shared memory
+
+#define MAX_SHM 20
+
+typedef enum { // Vacancy status of shm region
+  UNOCCUPIED,
+  OCCUPIED
+} vacancy;
+
+typedef struct {
+  uint32_t offset; // bottom of shm region
+  uint32_t   size; // size of shm region
+  vacancy   state; // region vacancy
+} region;
+
+// allocate a zeroed n-byte shm region, and a file referring to it; return NULL iff. there is no room
+extern file_t* shm_file( uint32_t n );
+
+#endif
@@ -0,0 +1,48 @@
+#include "smp.h"
+
+spinlock_t kernel_lock = 0;
+
+void spin_lock  ( spinlock_t* l ) {
+  uint32_t t;
+
+  asm volatile( "1: ldrex   %0, [ %1 ]     \n" // load   lock value, and tag address as exclusive
+                "   teq     %0, #0         \n" // if     locked, ...
+                "   wfene                  \n" // ... wait for event (i.e., an unlock)
+                "   strexeq %0, %2, [ %1 ] \n" // try to store locked value iff. unlocked
+                "   teqeq   %0, #0         \n"
+                "   bne     1b             \n" // retry iff. locked, or the store failed
+                "   dmb                    \n" // complete acquire before any critical section access
+              : "=&r" (t)
+              : "r" (l), "r" (1)
+              : "cc", "memory" );
+}
+
+void spin_unlock( spinlock_t* l ) {
+  asm volatile( "dmb" ::: "memory" );          // complete critical section accesses before release
+
+  *l = 0;
+
+  asm volatile( "dsb \n"                       // complete release, then ...
+                "sev \n"                       // ... signal event to any waiting CPU
+              ::: "memory" );
+}
+
+void smp_boot     ( void* x ) {
+  /* The QEMU boot loader parks each secondary CPU in a loop which waits
+   * for an interrupt, then jumps to the address in SYS_FLAGS iff. it is
+   * non-zero.
+   */
+
+  SYSCONF->FLAGSCLR = 0xFFFFFFFF;
+  SYSCONF->FLAGSSET = ( uint32_t )( x );
+
+  smp_broadcast( SGI_RESCHEDULE );
+}
+
+void smp_signal   ( int c ) {
+  GICD0->SGIR = ( 0x0 << 24 ) | ( ( 1 << c ) << 16 ) | SGI_RESCHEDULE; // target list = { c }
+}
+
+void smp_broadcast( int x ) {
+  GICD0->SGIR = ( 0x1 << 24 ) |                        x;              // target list = every CPU except this one
+}
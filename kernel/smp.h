@@ -0,0 +1,65 @@
+#ifndef __SMP_H
+#define __SMP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include   "GIC.h"
+#include   "SYS.h"
+
+/* The kernel can be built (with CONFIG_SMP defined) for a multi-core
+ * platform, i.e., the QEMU vexpress-a9 machine, with up to MAX_CPUS
+ * Cortex-A9 cores.  Note that
+ *
+ * - the primary CPU (i.e., CPU 0) is reset as normal, then wakes each
+ *   secondary CPU st. it starts executing at lolevel_handler_smp,
+ * - each CPU has its own IRQ, SVC and ABT mode stacks, its own idle
+ *   process, and tracks which process it is executing,
+ * - kernel data is protected by a (big) kernel lock, which is held for
+ *   the duration of each high-level handler, and
+ * - only CPU 0 takes interrupts from devices (e.g., the timer), so a CPU
+ *   signals others to reschedule (e.g., once a time slice ends, or if
+ *   they are idle and a process becomes ready), or to take a profiling
+ *   sample, using an SGI.
+ *
+ * Without CONFIG_SMP, MAX_CPUS = 1 and the same code degenerates into
+ * the uni-processor case.
+ */
+
+#if defined( CONFIG_SMP )
+#define MAX_CPUS       ( 4 )
+#else
+#define MAX_CPUS       ( 1 )
+#endif
+
+#define SGI_RESCHEDULE ( 0 )
+#define SGI_PROFILE    ( 1 )
+
+typedef volatile uint32_t spinlock_t;
+
+extern spinlock_t kernel_lock;
+
+// return ID of the executing CPU, i.e., MPIDR[ 1 : 0 ]
+static inline int cpu_id() {
+  uint32_t r;
+
+  asm volatile( "mrc p15, 0, %0, c0, c0, 5 \n" // read MPIDR
+              : "=r" (r) );
+
+  return r & 0x3;
+}
+
+// acquire spinlock l, waiting until it is free
+extern void spin_lock  ( spinlock_t* l );
+// release spinlock l
+extern void spin_unlock( spinlock_t* l );
+
+// wake each secondary CPU, st. it starts executing at address x
+extern void smp_boot     ( void* x );
+// signal CPU c to reschedule
+extern void smp_signal   ( int c );
+// raise SGI x (e.g., SGI_RESCHEDULE) on every other CPU
+extern void smp_broadcast( int x );
+
+#endif
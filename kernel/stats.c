@@ -0,0 +1,29 @@
+#include "stats.h"
+#include "hilevel.h"
+
+static uint32_t stats_cycles[ MAX_CPUS ]; // cycle counter  as of last charge, per CPU
+static uint32_t stats_instrs[ MAX_CPUS ]; // event counter  as of last charge, per CPU
+
+void stats_init() {
+  pmu_enable();
+
+  pmu_set_event( STATS_INSTR, PMU_EVENT_INSTR );
+
+  stats_cycles[ cpu_id() ] = pmu_cycles();
+  stats_instrs[ cpu_id() ] = pmu_count( STATS_INSTR );
+}
+
+void stats_charge( pcb_t* p, bool sys ) {
+  int c = cpu_id(); uint32_t t = pmu_cycles(), n = pmu_count( STATS_INSTR );
+
+  // Skip a process terminated meanwhile, st. its PCB is clean once reused
+  if( p != NULL && p->status != STATUS_TERMINATED && p->status != STATUS_INVALID ) {
+    if( sys ) p->stats.sys  += t - stats_cycles[ c ];
+    else      p->stats.user += t - stats_cycles[ c ];
+
+    p->stats.instrs += n - stats_instrs[ c ];
+  }
+
+  stats_cycles[ c ] = t;
+  stats_instrs[ c ] = n;
+}
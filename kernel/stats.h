@@ -0,0 +1,45 @@
+#ifndef __STATS_H
+#define __STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include   "PMU.h"
+
+#include   "smp.h"
+
+/* Each process accounts for where its time goes, in cycles of the PMU
+ * cycle counter (see PMU.h), st. it is possible to tell, e.g., whether it
+ * is CPU-bound or spends most time in the kernel.  Each CPU charges the
+ * cycles since it last did so on every transition into and out of the
+ * kernel:
+ *
+ * - cycles up to entering the kernel are charged as user time to the
+ *   process executing (which, for the idle process, is idle time), and
+ * - cycles up to leaving the kernel are charged as system time to the
+ *   same process, i.e., whichever caused the kernel to be entered, even
+ *   if another is dispatched meanwhile.
+ *
+ * Instructions are counted likewise, via a PMU event counter.
+ */
+
+#define STATS_INSTR ( 0 ) // PMU event counter which counts instructions
+
+typedef struct {
+  uint64_t     user; // cycles executing in USR mode
+  uint64_t      sys; // cycles executing in the kernel on behalf of the process
+  uint64_t   instrs; // instructions executed, in USR mode or in the kernel
+  uint32_t switches; // number of times dispatched, i.e., context switched to
+  uint32_t syscalls; // number of system calls made
+  uint32_t   faults; // number of page faults raised
+} stats_t;
+
+struct pcb;
+
+// enable PMU (on this CPU)
+extern void stats_init();
+// charge cycles since last charged (on this CPU) to process p (iff. any), as system time iff. sys, else user time
+extern void stats_charge( struct pcb* p, bool sys );
+
+#endif
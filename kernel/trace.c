@@ -0,0 +1,52 @@
+#include "trace.h"
+
+trace_ring_t trace_rings[ MAX_CPUS ];
+        bool trace_on = false;
+
+// Stage whichever events of ring c were recorded since the last drain (or as many as it still holds), then discard them
+static void trace_drain( int c ) {
+  trace_ring_t* r = &trace_rings[ c ];
+
+  uint32_t n = r->head - r->tail, h[ 3 ] = { TRACE_MAGIC, c, 0 };
+
+  if( n > TRACE_EVENTS ) {
+    n = TRACE_EVENTS; // i.e., the oldest were overwritten
+  }
+
+  h[ 2 ] = n; dump_put( h, sizeof( h ) );
+
+  for( uint32_t i = r->head - n; i != r->head; i++ ) {
+    dump_put( &r->events[ i & ( TRACE_EVENTS - 1 ) ], sizeof( trace_event_t ) );
+  }
+
+  r->tail = r->head;
+}
+
+bool trace_ctl( int x ) {
+  if     ( x == TRACE_STOP  ) {
+    trace_on = false;
+  }
+  else if( x == TRACE_START ) {
+    trace_on = true;
+  }
+  else if( x == TRACE_DUMP  ) {
+    if( !dump_open() ) {
+      return false;
+    }
+
+    bool on = trace_on; trace_on = false; // st. no CPU records an event mid-drain, since it may overwrite one being copied
+
+    for( int c = 0; c < MAX_CPUS; c++ ) {
+      trace_drain( c );
+    }
+
+    trace_on = on;
+
+    dump_close();
+  }
+  else {
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,92 @@
+#ifndef __TRACE_H
+#define __TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include   "smp.h"
+#include "clock.h"
+#include  "dump.h"
+
+/* Each CPU records what it does into its own trace ring, as fixed-size
+ * binary events, each timestamped by the clock (i.e., in microseconds):
+ * recording an event therefore costs a handful of stores and no lock,
+ * since only the CPU owning a ring (with interrupts disabled, i.e., in a
+ * handler) ever writes to it.  Once full, a ring overwrites its oldest
+ * events.
+ *
+ * Tracing is off until started (e.g., via the console); the rings are
+ * then drained on demand, as a binary dump written to DUMP_UART (see
+ * dump.h): for each CPU, a header of TRACE_MAGIC, the CPU and the number
+ * of events, then the events themselves (little-endian, per
+ * trace_event_t).  The rings are copied into the dump at once, so can be
+ * recorded into again while it is written; a request to drain them is
+ * rejected until the previous dump (of any kind) has been written.  The
+ * host-side device/trace.py converts a dump to Chrome trace (i.e., JSON
+ * that Perfetto also reads), so per-process timelines can be inspected.
+ */
+
+#define TRACE_EVENTS ( 1024 )       // events per ring, which must be a power of 2
+#define TRACE_MAGIC  ( 0x54524331 ) // i.e., "TRC1"
+
+#define TRACE_STOP   ( 0 )          // per SYS_TRACE: stop recording
+#define TRACE_START  ( 1 )          //                start (or resume) recording
+#define TRACE_DUMP   ( 2 )          //                drain rings to DUMP_UART
+
+typedef enum {
+  TRACE_SWITCH,                     // arg = PID of process dispatched
+  TRACE_IRQ_ENTER,                  // arg = interrupt identifier
+  TRACE_IRQ_EXIT,                   // arg = interrupt identifier
+  TRACE_SVC_ENTER,                  // arg = system call identifier
+  TRACE_SVC_EXIT,                   // arg = system call identifier
+  TRACE_FORK,                       // arg = PID of process created (e.g., via fork, spawn or thread_create)
+  TRACE_EXIT,                       // arg = PID of process terminated
+  TRACE_WAIT,                       // arg = wait channel
+  TRACE_WAKE                        // arg = PID of process woken
+} trace_type_t;
+
+typedef struct {
+  uint32_t time;                    // clock, as of event
+   uint8_t type;                    // type, per trace_type_t
+   uint8_t  cpu;                    // CPU which recorded event
+   int16_t  pid;                    // PID of process executing, or -1 iff. idle
+  uint32_t  arg;                    // per type
+} trace_event_t;
+
+typedef struct {
+  trace_event_t events[ TRACE_EVENTS ];
+       uint32_t head;               // number of events recorded
+       uint32_t tail;               // number of events recorded as of last drain
+} trace_ring_t;
+
+extern trace_ring_t trace_rings[ MAX_CPUS ];
+extern         bool trace_on;
+
+// record event of type x with argument y, wrt. process pid executing on this CPU, as of time t (e.g., once it is known the event happened)
+static inline void trace_event_at( trace_type_t x, int pid, uint32_t y, uint32_t t ) {
+  if( !trace_on ) return;
+
+  trace_ring_t*  r = &trace_rings[ cpu_id() ];
+  trace_event_t* e = &r->events[ r->head & ( TRACE_EVENTS - 1 ) ];
+
+  e->time = t;
+  e->type = x;
+  e->cpu  = cpu_id();
+  e->pid  = pid;
+  e->arg  = y;
+
+  r->head++;
+}
+
+// record event of type x with argument y, wrt. process pid executing on this CPU, as of now
+static inline void trace_event( trace_type_t x, int pid, uint32_t y ) {
+  if( !trace_on ) return;
+
+  trace_event_at( x, pid, y, clock_now() );
+}
+
+// start, stop or drain the trace rings per x (e.g., TRACE_DUMP); return false iff. x is invalid, or (for TRACE_DUMP) a dump is still draining
+extern bool trace_ctl( int x );
+
+#endif
@@ -0,0 +1,74 @@
+#include "tty.h"
+
+tty_t ttys[ MAX_TTYS ];
+
+/* Move as many bytes as possible from the TX ring into the UART FIFO,
+ * then unmask the TX interrupt iff. some remain: once the FIFO drains,
+ * the interrupt handler will call this function again.
+ */
+
+static void tty_drain( tty_t* t ) {
+  uint8_t x;
+
+  while( PL011_can_putc( t->uart ) && ring_read( &t->tx, &x, 1 ) ) {
+    PL011_putc( t->uart, x, false );
+  }
+
+  if( ring_len( &t->tx ) > 0 ) {
+    t->uart->IMSC |=  0x00000020; // unmask TX interrupt
+  }
+  else {
+    t->uart->IMSC &= ~0x00000020; //   mask TX interrupt
+  }
+}
+
+void tty_init( tty_t* t, PL011_t* d ) {
+  t->uart = d;
+
+  ring_init( &t->rx );
+  ring_init( &t->tx );
+
+  d->ICR   = 0x000007FF; // clear  all interrupts
+  d->IMSC  = 0x00000050; // unmask RX and RX timeout interrupts
+}
+
+int  tty_write( tty_t* t, const uint8_t* x, int n ) {
+  /* A write that fits into the ring is atomic, i.e., either all or none
+   * of it is queued: this prevents lines written by different processes
+   * being interleaved.  A larger write is queued piecemeal.
+   */
+
+  if( ( n <= RING_SIZE ) && ( ring_free( &t->tx ) < n ) ) {
+    return 0;
+  }
+
+  int r = ring_write( &t->tx, x, n );
+
+  tty_drain( t );
+
+  return r;
+}
+
+int  tty_read ( tty_t* t,       uint8_t* x, int n ) {
+  return ring_read( &t->rx, x, n );
+}
+
+void tty_handler_irq( tty_t* t ) {
+  uint32_t mis = t->uart->MIS;
+
+  if( mis & 0x00000050 ) { // RX or RX timeout interrupt
+    while( PL011_can_getc( t->uart ) ) {
+      uint8_t x = PL011_getc( t->uart, false );
+
+      ring_write( &t->rx, &x, 1 ); // drop byte iff. RX ring is full
+    }
+
+    t->uart->ICR = 0x00000050;
+  }
+
+  if( mis & 0x00000020 ) { // TX interrupt
+    t->uart->ICR = 0x00000020;
+
+    tty_drain( t );
+  }
+}
@@ -0,0 +1,45 @@
+#ifndef __TTY_H
+#define __TTY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "PL011.h"
+
+#include  "ring.h"
+
+/* A tty wraps a PL011 instance with a pair of ring buffers, st. neither
+ * the kernel nor a process ever has to busy-wait on the UART:
+ *
+ * - bytes written are queued in the TX ring, then moved into the UART
+ *   FIFO as space allows; the TX interrupt signals more space, and
+ * - bytes received are moved from the UART FIFO into the RX ring by the
+ *   RX interrupt, then consumed later by a read.
+ *
+ * The TX interrupt is only unmasked while the TX ring is non-empty, so
+ * an idle tty raises no interrupts other than for RX.
+ */
+
+#define MAX_TTYS ( 2 )
+
+typedef struct {
+  PL011_t* uart; // underlying PL011 instance
+    ring_t   rx; // bytes received,    waiting to be read
+    ring_t   tx; // bytes written,     waiting to be transmitted
+} tty_t;
+
+extern tty_t ttys[ MAX_TTYS ];
+
+// initialise tty t wrt. PL011 instance d, and enable RX interrupts
+extern void tty_init( tty_t* t, PL011_t* d );
+
+// queue n bytes from x for transmission; return bytes queued
+extern int  tty_write( tty_t* t, const uint8_t* x, int n );
+// dequeue up to n received bytes into x; return bytes dequeued
+extern int  tty_read ( tty_t* t,       uint8_t* x, int n );
+
+// handle an interrupt raised by the PL011 instance underlying tty t
+extern void tty_handler_irq( tty_t* t );
+
+#endif
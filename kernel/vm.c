@@ -0,0 +1,189 @@
+#include "vm.h"
+#include "image.h"
+
+static uint32_t vm_l1[ MAX_CPUS ][ 4096 ] __attribute__(( aligned( 16384 ) )); // 1st-level page table, per CPU
+
+static  uint8_t vm_frames[ VM_FRAMES ][ VM_PAGE ] __attribute__(( aligned( VM_PAGE ) ));
+static  uint8_t vm_frame_refs[ VM_FRAMES ];
+
+vm_t vms[ MAX_VMS ];
+
+static vm_t* vm_current[ MAX_CPUS ]; // address space current on each CPU
+
+#define VM_L1_SECTION 0x00000C02 // section,     AP = 11 (i.e., read/write)
+#define VM_L1_TABLE   0x00000001 // page table,  domain 0
+#define VM_L2_RW      0x00000032 // small page,  AP = 11 (i.e., read/write)
+#define VM_L2_RO      0x00000022 // small page,  AP = 10 (i.e., read-only in USR mode)
+
+void vm_init() {
+  for( int c = 0; c < MAX_CPUS; c++ ) {
+    for( int i = 0; i < 4096; i++ ) {
+      vm_l1[ c ][ i ] = ( i << 20 ) | VM_L1_SECTION; // map 1 MiB at i * 2^20 to itself
+    }
+
+    vm_l1[ c ][ VM_BASE >> 20 ] = 0;                 // fault iff. no address space is current
+  }
+}
+
+void vm_enable() {
+  mmu_set_ptr0( vm_l1[ cpu_id() ] );
+  mmu_set_dom( 0, 0x1 );                             // domain 0 = client, i.e., check permissions
+  mmu_flush();
+  mmu_enable();
+}
+
+// -------------------------------------------------------------------------------------------------------------------
+// Frames
+
+uint32_t vm_frame_alloc() {
+  /* If every frame is in use, reclaim those which only cache pages of an
+   * image no process is using, then try again.
+   */
+
+  for( int k = 0; k < 2; k++ ) {
+    for( int i = 0; i < VM_FRAMES; i++ ) {
+      if( vm_frame_refs[ i ] == 0 ) {
+        vm_frame_refs[ i ] = 1;
+        return ( uint32_t )( vm_frames[ i ] );
+      }
+    }
+
+    if( !image_reclaim() ) break;
+  }
+
+  return 0; // If no free frame
+}
+
+void     vm_frame_dup ( uint32_t f ) {
+  vm_frame_refs[ ( f - ( uint32_t )( vm_frames ) ) / VM_PAGE ]++;
+}
+
+void     vm_frame_free( uint32_t f ) {
+  vm_frame_refs[ ( f - ( uint32_t )( vm_frames ) ) / VM_PAGE ]--;
+}
+
+// -------------------------------------------------------------------------------------------------------------------
+// Address spaces
+
+vm_t* vm_alloc ( image_t* x ) {
+  for( int i = 0; i < MAX_VMS; i++ ) {
+    if( vms[ i ].refs == 0 ) {
+      memset( vms[ i ].pt, 0, sizeof( vms[ i ].pt ) );
+      vms[ i ].refs  = 1;
+      vms[ i ].image = x;
+
+      return &vms[ i ];
+    }
+  }
+
+  return NULL; // If no free address space
+}
+
+vm_t* vm_fork  ( vm_t* vm ) {
+  vm_t* r = vm_alloc( vm->image );
+  if( r == NULL ) return NULL;
+
+  // Share read-only pages, and copy writable ones
+  for( int i = 0; i < VM_PAGES; i++ ) {
+    uint32_t e = vm->pt[ i ], f = e & ~( VM_PAGE - 1 );
+
+    if     ( e == 0 ) {
+      continue;
+    }
+    else if( ( e & VM_L2_RW ) == VM_L2_RO ) {
+      vm_frame_dup( f ); r->pt[ i ] = e;
+    }
+    else {
+      uint32_t g = vm_frame_alloc();
+      if( g == 0 ) {
+        r->image = NULL; vm_free( r ); return NULL;
+      }
+
+      mem_copy( ( void* )( g ), ( void* )( f ), VM_PAGE ); r->pt[ i ] = g | VM_L2_RW;
+    }
+  }
+
+  image_dup( r->image );
+
+  return r;
+}
+
+void  vm_dup   ( vm_t* vm ) {
+  vm->refs++;
+}
+
+void  vm_free  ( vm_t* vm ) {
+  if( --vm->refs > 0 ) return;
+
+  bool remote = false;
+
+  // Unmap from any CPU it is current on, i.e., not only this one (e.g., iff. a process executing on another is killed)
+  for( int c = 0; c < MAX_CPUS; c++ ) {
+    if( vm_current[ c ] == vm ) {
+      vm_l1[ c ][ VM_BASE >> 20 ] = 0; vm_current[ c ] = NULL;
+
+      if( c == cpu_id() ) mmu_flush(); else remote = true;
+    }
+  }
+
+  // Another CPU may still hold TLB entries for the window, so flush them before any frame is reused (e.g., by another process)
+  if( remote ) mmu_flush_all();
+
+  for( int i = 0; i < VM_PAGES; i++ ) {
+    if( vm->pt[ i ] != 0 ) vm_frame_free( vm->pt[ i ] & ~( VM_PAGE - 1 ) );
+  }
+
+  if( vm->image != NULL ) image_put( vm->image );
+
+  memset( vm, 0, sizeof( vm_t ) );
+}
+
+void  vm_switch( vm_t* vm ) {
+  int c = cpu_id();
+
+  if( vm_current[ c ] == vm ) return;
+
+  vm_l1[ c ][ VM_BASE >> 20 ] = ( vm != NULL ) ? ( ( uint32_t )( vm->pt ) | VM_L1_TABLE ) : 0;
+  vm_current[ c ]             = vm;
+
+  mmu_flush();
+}
+
+bool  vm_fault ( vm_t* vm, uint32_t x ) {
+  if( vm == NULL || x < VM_BASE || x >= VM_TOP ) return false;
+
+  int      i = ( x - VM_BASE ) / VM_PAGE;
+  uint32_t v = VM_BASE + ( i * VM_PAGE ), f;
+
+  if( vm->pt[ i ] != 0 ) return false; // If mapped already, access must violate permissions
+
+  if( v >= ( VM_TOP - VM_STACK ) ) {   // stack
+    if( ( f = vm_frame_alloc() ) == 0 ) return false;
+
+    mem_zero( ( void* )( f ), VM_PAGE ); vm->pt[ i ] = f | VM_L2_RW;
+  }
+  else {                               // image
+    bool shared;
+
+    if( ( f = image_page( vm->image, v, &shared ) ) == 0 ) return false;
+
+    vm->pt[ i ] = f | ( shared ? VM_L2_RO : VM_L2_RW );
+  }
+
+  return true;
+}
+
+bool  vm_check ( vm_t* vm, uint32_t x, uint32_t n, bool write ) {
+  if( vm == NULL || x < VM_BASE || x >= VM_TOP || n > ( VM_TOP - x ) ) return false;
+
+  for( uint32_t v = x & ~( VM_PAGE - 1 ); v < ( x + n ); v += VM_PAGE ) {
+    int i = ( v - VM_BASE ) / VM_PAGE;
+
+    if( vm->pt[ i ] == 0 && !vm_fault( vm, v ) ) return false;
+
+    // A read-only page is only so in USR mode, so the kernel must not write it on behalf of a process (e.g., a shared page of an image)
+    if( write && ( vm->pt[ i ] & VM_L2_RW ) != VM_L2_RW ) return false;
+  }
+
+  return true;
+}
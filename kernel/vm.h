@@ -0,0 +1,82 @@
+#ifndef __VM_H
+#define __VM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string.h>
+
+#include   "MMU.h"
+
+#include     "mem.h"
+#include     "smp.h"
+
+/* The MMU maps (almost) all of the address space 1-to-1 using sections,
+ * st. the kernel and any program linked into it see the same addresses
+ * as they would with the MMU disabled.  The exception is a window of
+ * VM_SIZE bytes at VM_BASE, which is where a program loaded from disk
+ * (i.e., an image) executes: each such process has an address space,
+ * which maps the window page by page.  Note that
+ *
+ * - pages are mapped on demand: a page is only allocated (and filled,
+ *   e.g., from the image) once the process first touches it, which
+ *   raises a translation fault,
+ * - read-only pages of an image are shared by every address space that
+ *   maps it, whereas writable pages are private,
+ * - the top VM_STACK bytes of the window are reserved for the stack, and
+ *   are zero-filled on demand, and
+ * - pages are allocated from a fixed pool of frames, each of which is
+ *   reference counted, and
+ * - each CPU has its own 1st-level page table, st. each can have a
+ *   different address space current.
+ */
+
+#define VM_BASE   ( 0x40000000 )
+#define VM_SIZE   ( 0x00100000 ) // 1 MiB, i.e., 1 section
+#define VM_TOP    ( VM_BASE + VM_SIZE )
+#define VM_STACK  ( 0x00010000 )
+
+#define VM_PAGE   ( 0x00001000 ) // 4 KiB, i.e., 1 small page
+#define VM_PAGES  ( VM_SIZE / VM_PAGE )
+
+#define VM_FRAMES ( 128 )
+#define MAX_VMS   (  20 )
+
+typedef struct image image_t;
+
+typedef struct {
+  uint32_t    pt[ VM_PAGES ]; // 2nd-level page table, st. pt[ i ] maps i-th page of window
+       int  refs;             // number of processes using address space
+   image_t* image;            // image mapped into window
+} __attribute__(( aligned( 1024 ) )) vm_t;
+
+// build 1-to-1 mapping (for every CPU)
+extern void     vm_init();
+// enable MMU (on this CPU)
+extern void     vm_enable();
+
+// allocate a frame; return its address, or 0 iff. none are free
+extern uint32_t vm_frame_alloc();
+// add    a reference to   frame f
+extern void     vm_frame_dup  ( uint32_t f );
+// remove a reference from frame f, releasing it iff. it was the last
+extern void     vm_frame_free ( uint32_t f );
+
+// allocate an (empty) address space which maps image x; return NULL iff. none are free
+extern vm_t*    vm_alloc ( image_t* x );
+// allocate a copy of address space vm; return NULL iff. there is no room
+extern vm_t*    vm_fork  ( vm_t* vm );
+// add    a reference to   address space vm (e.g., for a thread)
+extern void     vm_dup   ( vm_t* vm );
+// remove a reference from address space vm, releasing it iff. it was the last
+extern void     vm_free  ( vm_t* vm );
+
+// make address space vm (or none iff. vm = NULL) current on this CPU, which costs nothing iff. it is current already
+extern void     vm_switch( vm_t* vm );
+// map page containing address x in address space vm; return false iff. x is invalid
+extern bool     vm_fault ( vm_t* vm, uint32_t x );
+// map each page of [ x, x + n ) in address space vm (iff. not mapped already); return false iff. any is invalid, or read-only and write
+extern bool     vm_check ( vm_t* vm, uint32_t x, uint32_t n, bool write );
+
+#endif
@@ -0,0 +1,13 @@
+// Program to show that pipes work: copy standard input to standard output, until end of file
+
+#include "libc.h"
+
+int main() {
+  char x[ 64 ]; int n;
+
+  while( ( n = read( STDIN_FILENO, x, 64 ) ) > 0 ) {
+    write( STDOUT_FILENO, x, n );
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,10 @@
+/* The entry point of a program loaded from disk: the kernel starts it
+ * with an empty stack at the top of the VM window, so all that remains
+ * is to call main then exit with whatever status it returns.
+ */
+
+.global _start
+
+_start:              bl    main                    @ invoke main
+                     bl    exit                    @ invoke exit, with status = result of main
+                     b     .                       @ unreachable
@@ -7,27 +7,32 @@
 
 #include "P3.h"
 
-uint32_t weight( uint32_t x ) {
-  x = ( x & 0x55555555 ) + ( ( x >>  1 ) & 0x55555555 );
-  x = ( x & 0x33333333 ) + ( ( x >>  2 ) & 0x33333333 );
-  x = ( x & 0x0F0F0F0F ) + ( ( x >>  4 ) & 0x0F0F0F0F );
-  x = ( x & 0x00FF00FF ) + ( ( x >>  8 ) & 0x00FF00FF );
-  x = ( x & 0x0000FFFF ) + ( ( x >> 16 ) & 0x0000FFFF );
-
-  return x;
-}
-
 void main_P3() {
+  uint32_t x[ P3_BLOCK ];
+
   while( 1 ) {
     write( STDOUT_FILENO, "P3", 2 );
 
     uint32_t lo = 1 <<  8;
     uint32_t hi = 1 << 24;
+    uint32_t  r = 0;
+
+    // Compute the weight of each x in blocks rather than 1 at a time, st. bits_weight can use NEON
+    for( uint32_t i = lo; i < hi; i += P3_BLOCK ) {
+      for( int j = 0; j < P3_BLOCK; j++ ) {
+        x[ j ] = i + j;
+      }
 
-    for( uint32_t x = lo; x < hi; x++ ) {
-      uint32_t r = weight( x ); 
+      r += bits_weight( x, P3_BLOCK );
+    }
+
+    // Check the total, st. a fault in bits_weight (or in preserving the NEON registers it uses) is evident
+    if( r != P3_WEIGHT ) {
+      write( STDOUT_FILENO, "P3 error", 8 );
     }
   }
 
   exit( EXIT_SUCCESS );
 }
+
+PROGRAM( "P3", main_P3, 0x0400, 1 );
@@ -13,5 +13,9 @@
 #include <stdint.h>
 
 #include "libc.h"
+#include "bits.h"
+
+#define P3_BLOCK  (        64 ) // number of words per call to bits_weight
+#define P3_WEIGHT ( 201325568 ) // total weight of each x in [ 2^8, 2^24 ), i.e., 24 * 2^23 - 8 * 2^7
 
 #endif
@@ -7,31 +7,30 @@
 
 #include "P4.h"
 
-uint32_t gcd( uint32_t x, uint32_t y ) {
-  if     ( x == y ) {
-    return x;
-  }
-  else if( x >  y ) {
-    return gcd( x - y, y );
-  }
-  else if( x <  y ) {
-    return gcd( x, y - x );
-  }
-}
-
 void main_P4() {
+  uint32_t x[ P4_BATCH ], y[ P4_BATCH ], r[ P4_BATCH ];
+
+  // Fill the table shared with any other process executing P4, unless one has already
+  gcd_memoise();
+
   while( 1 ) {
     write( STDOUT_FILENO, "P4", 2 );
 
     uint32_t lo = 1 <<  4;
     uint32_t hi = 1 <<  8;
 
-    for( uint32_t x = lo; x < hi; x++ ) {
-      for( uint32_t y = lo; y < hi; y++ ) {
-        uint32_t r = gcd( x, y ); 
+    for( uint32_t i = lo; i < hi; i++ ) {
+      for( uint32_t j = lo; j < hi; j += P4_BATCH ) {
+        for( int k = 0; k < P4_BATCH; k++ ) {
+          x[ k ] = i; y[ k ] = j + k;
+        }
+
+        gcd_batch( r, x, y, P4_BATCH );
       }
     }
   }
 
   exit( EXIT_SUCCESS );
 }
+
+PROGRAM( "P4", main_P4, 0x0400, 1 );
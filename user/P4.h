@@ -13,5 +13,8 @@
 #include <stdint.h>
 
 #include "libc.h"
+#include  "gcd.h"
+
+#define P4_BATCH ( 16 ) // number of pairs per call to gcd_batch
 
 #endif
@@ -7,31 +7,48 @@
 
 #include "P5.h"
 
-int is_prime( uint32_t x ) {
-  if ( !( x & 1 ) || ( x < 2 ) ) {
-    return ( x == 2 );
-  }
+void main_P5() {
+  int fd = shm_open( sizeof( p5_region_t ) );
 
-  for( uint32_t d = 3; ( d * d ) <= x ; d += 2 ) {
-    if( !( x % d ) ) {
-      return 0;
-    }
-  }
+  p5_region_t* r = ( fd >= 0 ) ? mmap( fd ) : NULL;
 
-  return 1;
-}
+  if( r == NULL ) {
+    write( STDERR_FILENO, "P5: no shm\n", 11 ); exit( EXIT_FAILURE );
+  }
 
-void main_P5() {
   for( int i = 0; i < 25; i++ ) {
     write( STDOUT_FILENO, "P5", 2 );
 
-    uint32_t lo = 1 <<  8;
-    uint32_t hi = 1 << 16;
+    primes_t x; primes_init( &x, r->bits, P5_LO, P5_HI );
+
+    // Split the range into a slice per worker, each a multiple of 64 numbers st. no two share a word of the bitmap
+    uint32_t n = ( ( x.hi - x.lo + ( 64 * P5_WORKERS ) - 1 ) / ( 64 * P5_WORKERS ) ) * 64;
+
+    for( int w = 1; w < P5_WORKERS; w++ ) {
+      int pid = fork();
 
-    for( uint32_t x = lo; x < hi; x++ ) {
-      int r = is_prime( x ); 
+      if( pid <= 0 ) { // sieve slice in child, or (iff. fork failed) in parent
+        primes_sieve( &x, x.lo + ( w * n ), x.lo + ( ( w + 1 ) * n ) ); sem_post( &r->done );
+
+        if( pid == 0 ) exit( EXIT_SUCCESS );
+      }
+    }
+
+    primes_sieve( &x, x.lo, x.lo + n );
+
+    for( int w = 1; w < P5_WORKERS; w++ ) {
+      sem_wait( &r->done );
+    }
+
+    // Check the count, st. a slice some worker failed to sieve (e.g., since the region is not shared) is evident
+    if( primes_count( &x, P5_LO, P5_HI ) != P5_PRIMES ) {
+      write( STDOUT_FILENO, "P5 error", 8 );
     }
   }
 
+  close( fd );
+
   exit( EXIT_SUCCESS );
 }
+
+PROGRAM( "P5", main_P5, 0x0400, 1 );
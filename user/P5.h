@@ -13,5 +13,16 @@
 #include <stdint.h>
 
 #include "libc.h"
+#include "primes.h"
+
+#define P5_LO      ( 1 <<  8 )
+#define P5_HI      ( 1 << 16 )
+#define P5_WORKERS (       4 ) // number of processes (including the parent) which sieve a slice of the range
+#define P5_PRIMES  (    6488 ) // number of primes in [ P5_LO, P5_HI )
+
+typedef struct {
+  uint32_t done;                                // semaphore: number of slices sieved by workers
+  uint32_t bits[ PRIMES_WORDS( P5_LO, P5_HI ) ]; // bitmap, per primes_t
+} p5_region_t;
 
 #endif
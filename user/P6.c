@@ -1,9 +1,11 @@
-// Program to show that the priority+age-based scheduling works
+// Program to show that the priority-weighted (i.e., fair-share) scheduling works
 
 #include "P6.h"
 
-// Assign console base priority to 10 and exit
+// Assign console base priority to 10 (i.e., ~7 times the CPU share of a default process) and exit
 void main_P6() {
   nice( 0, 10 );
   exit( EXIT_SUCCESS );
 }
+
+PROGRAM( "P6", main_P6, 0x0200, 1 );
@@ -0,0 +1,195 @@
+// Program to measure the cost of scheduling, system calls, process creation and synchronisation, plus kernel copy and zero
+
+#include "bench.h"
+
+/* Each benchmark performs an operation some number of times, then reports
+ * the mean number of cycles (per the PMU cycle counter, see cycles) each
+ * took on one line starting "bench:", st. the suite can be executed
+ * headless (see make bench) and a kernel change checked for regressions
+ * by comparing numbers.  Note that reading the counter is a system call,
+ * whose cost is amortised over every operation, and that on an SMP build,
+ * a process may migrate between CPUs (whose counters differ slightly)
+ * mid-benchmark.
+ */
+
+static void report( const char* name, uint32_t n, uint32_t t ) {
+  printf( "bench: %-16s %6u ops %10u cycles/op\n", name, n, t / n ); fflush( stdout );
+}
+
+// System call round trip, i.e., a write which fails at once (on an invalid file descriptor)
+static void bench_syscall() {
+  uint32_t t = cycles();
+
+  for( int i = 0; i < BENCH_N; i++ ) {
+    write( -1, NULL, 0 );
+  }
+
+  report( "syscall", BENCH_N, cycles() - t );
+}
+
+// System call round trip that does some work, i.e., a getpid (both are made via the light path, see the kernel)
+static void bench_getpid() {
+  uint32_t t = cycles();
+
+  for( int i = 0; i < BENCH_N; i++ ) {
+    getpid();
+  }
+
+  report( "getpid", BENCH_N, cycles() - t );
+}
+
+// Context switch, i.e., two processes which yield to each other (the child posts a semaphore, which, like any static data of a program, it shares, once done)
+static uint32_t bench_yielded = 0;
+
+static void bench_yield() {
+  if( fork() == 0 ) {
+    for( int i = 0; i < BENCH_N; i++ ) yield();
+
+    sem_post( &bench_yielded );
+
+    exit( EXIT_SUCCESS );
+  }
+
+  uint32_t t = cycles();
+
+  for( int i = 0; i < BENCH_N; i++ ) {
+    yield();
+  }
+
+  sem_wait( &bench_yielded );
+
+  report( "yield", 2 * BENCH_N, cycles() - t );
+}
+
+// Process creation and termination, i.e., a fork whose child exits at once
+static void bench_fork() {
+  uint32_t t = cycles();
+
+  for( int i = 0; i < BENCH_FORKS; i++ ) {
+    int r;
+
+    while( ( r = fork() ) < 0 ) { // process table is full, so wait for children to exit
+      yield();
+    }
+
+    if( r == 0 ) {
+      exit( EXIT_SUCCESS );
+    }
+
+    yield();
+  }
+
+  report( "fork/exit", BENCH_FORKS, cycles() - t );
+}
+
+// Producer/consumer, i.e., two processes which pass items via a ring in a shm region, synchronised by semaphores
+static void bench_shm() {
+  int fd = shm_open( sizeof( bench_ring_t ) );
+
+  bench_ring_t* ring = ( fd >= 0 ) ? mmap( fd ) : NULL;
+
+  if( ring == NULL ) {
+    printf( "bench: shm failed\n" ); return;
+  }
+
+  ring->spaces = BENCH_RING;
+
+  if( fork() == 0 ) {
+    for( int i = 0; i < BENCH_N; i++ ) {
+      sem_wait( &ring->items  ); ring->sum += ring->slots[ i % BENCH_RING ];
+      sem_post( &ring->spaces );
+    }
+
+    ring->done = 1;
+
+    exit( EXIT_SUCCESS );
+  }
+
+  uint32_t t = cycles();
+
+  for( int i = 0; i < BENCH_N; i++ ) {
+    sem_wait( &ring->spaces ); ring->slots[ i % BENCH_RING ] = i;
+    sem_post( &ring->items  );
+  }
+
+  while( !ring->done ) {
+    yield();
+  }
+
+  report( "shm", BENCH_N, cycles() - t );
+
+  if( ring->sum != ( BENCH_N * ( BENCH_N - 1 ) ) / 2 ) {
+    printf( "bench: shm sum invalid\n" );
+  }
+
+  shm_unlink( fd ); close( fd );
+}
+
+// Semaphore contention, i.e., threads which each increment a counter in a critical section
+static uint32_t bench_lock = 1, bench_count = 0;
+
+static void bench_worker( void* x ) {
+  for( int i = 0; i < ( BENCH_N / BENCH_THREADS ); i++ ) {
+    sem_wait( &bench_lock ); bench_count++;
+    sem_post( &bench_lock );
+  }
+}
+
+static void bench_sem() {
+  int tids[ BENCH_THREADS ];
+
+  uint32_t t = cycles();
+
+  for( int i = 0; i < BENCH_THREADS; i++ ) {
+    tids[ i ] = thread_create( &bench_worker, NULL );
+  }
+  for( int i = 0; i < BENCH_THREADS; i++ ) {
+    if( tids[ i ] >= 0 ) thread_join( tids[ i ] );
+  }
+
+  report( "sem", BENCH_N, cycles() - t );
+
+  if( bench_count != BENCH_N ) {
+    printf( "bench: sem count invalid\n" );
+  }
+}
+
+// Copy and zero per size class, i.e., the kernel routines (see kernel/mem.h, which are pure, so can be called in USR mode) vs. the C library
+static uint8_t bench_x[ BENCH_MEM ] __attribute__(( aligned( 64 ) ));
+static uint8_t bench_y[ BENCH_MEM ] __attribute__(( aligned( 64 ) ));
+
+static void bench_mem() {
+  for( uint32_t n = 16; n <= BENCH_MEM; n *= 4 ) {
+    uint32_t t[ 4 ];
+
+    t[ 0 ] = cycles(); for( int i = 0; i < BENCH_N; i++ ) memcpy  ( bench_x, bench_y, n );
+    t[ 0 ] = cycles() - t[ 0 ];
+    t[ 1 ] = cycles(); for( int i = 0; i < BENCH_N; i++ ) mem_copy( bench_x, bench_y, n );
+    t[ 1 ] = cycles() - t[ 1 ];
+    t[ 2 ] = cycles(); for( int i = 0; i < BENCH_N; i++ ) memset  ( bench_x, 0,       n );
+    t[ 2 ] = cycles() - t[ 2 ];
+    t[ 3 ] = cycles(); for( int i = 0; i < BENCH_N; i++ ) mem_zero( bench_x,          n );
+    t[ 3 ] = cycles() - t[ 3 ];
+
+    printf( "bench: copy %-11u %6u ops %10u cycles/op (libc %u)\n", n, BENCH_N, t[ 1 ] / BENCH_N, t[ 0 ] / BENCH_N );
+    printf( "bench: zero %-11u %6u ops %10u cycles/op (libc %u)\n", n, BENCH_N, t[ 3 ] / BENCH_N, t[ 2 ] / BENCH_N );
+  }
+
+  fflush( stdout );
+}
+
+void main_bench() {
+  bench_syscall();
+  bench_getpid();
+  bench_yield();
+  bench_fork();
+  bench_shm();
+  bench_sem();
+  bench_mem();
+
+  printf( "bench: done\n" ); fflush( stdout );
+
+  exit( EXIT_SUCCESS );
+}
+
+PROGRAM( "bench", main_bench, 0x0400, 1 );
@@ -0,0 +1,34 @@
+/* Copyright (C) 2017 Daniel Page <csdsp@bristol.ac.uk>
+ *
+ * Use of this source code is restricted per the CC BY-NC-ND license, a copy of 
+ * which can be found via http://creativecommons.org (and should be included as 
+ * LICENSE.txt within the associated archive or repository).
+ */
+
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string.h>
+
+#include "libc.h"
+#include  "mem.h"
+
+#define BENCH_N       ( 1024 ) // number of operations per benchmark
+#define BENCH_FORKS   (   64 ) // number of operations for fork/exit, which is far slower
+#define BENCH_RING    (   16 ) // number of slots in producer/consumer ring
+#define BENCH_THREADS (    4 ) // number of threads contending for a semaphore
+#define BENCH_MEM     ( 4096 ) // largest size class for copy and zero, i.e., a page (or process stack)
+
+typedef struct {
+  uint32_t items;                // semaphore: number of slots full
+  uint32_t spaces;               // semaphore: number of slots empty
+  uint32_t done;                 // consumer has consumed every item
+  uint32_t sum;                  // sum of items consumed, as a check
+  uint32_t slots[ BENCH_RING ];
+} bench_ring_t;
+
+#endif
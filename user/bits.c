@@ -0,0 +1,123 @@
+/* Copyright (C) 2017 Daniel Page <csdsp@bristol.ac.uk>
+ *
+ * Use of this source code is restricted per the CC BY-NC-ND license, a copy of 
+ * which can be found via http://creativecommons.org (and should be included as 
+ * LICENSE.txt within the associated archive or repository).
+ */
+
+#include "bits.h"
+
+// Population count of 1 word, using SWAR (i.e., summing adjacent fields of 1, 2, 4, 8 then 16 bits in parallel)
+static uint32_t bits_weight1( uint32_t x ) {
+  x = ( x & 0x55555555 ) + ( ( x >>  1 ) & 0x55555555 );
+  x = ( x & 0x33333333 ) + ( ( x >>  2 ) & 0x33333333 );
+  x = ( x & 0x0F0F0F0F ) + ( ( x >>  4 ) & 0x0F0F0F0F );
+  x = ( x & 0x00FF00FF ) + ( ( x >>  8 ) & 0x00FF00FF );
+  x = ( x & 0x0000FFFF ) + ( ( x >> 16 ) & 0x0000FFFF );
+
+  return x;
+}
+
+#if defined( __ARM_NEON__ )
+// Population count of 4 words, accumulated (as 4 32-bit sums) into a
+static inline uint32x4_t bits_weight4( uint32x4_t a, uint32x4_t x ) {
+  return vpadalq_u16( a, vpaddlq_u8( vcntq_u8( vreinterpretq_u8_u32( x ) ) ) );
+}
+
+// Sum of 4 32-bit sums in a
+static inline uint32_t   bits_sum4( uint32x4_t a ) {
+  uint64x2_t t = vpaddlq_u32( a );
+
+  return vgetq_lane_u64( t, 0 ) + vgetq_lane_u64( t, 1 );
+}
+#endif
+
+uint32_t bits_weight( const uint32_t* x, int n ) {
+  uint32_t r = 0; int i = 0;
+
+#if defined( __ARM_NEON__ )
+  uint32x4_t a = vdupq_n_u32( 0 );
+
+  for( ; ( i + 4 ) <= n; i += 4 ) {
+    a = bits_weight4( a, vld1q_u32( x + i ) );
+  }
+
+  r = bits_sum4( a );
+#endif
+
+  for( ; i < n; i++ ) {
+    r += bits_weight1( x[ i ] );
+  }
+
+  return r;
+}
+
+uint32_t bits_dist  ( const uint32_t* x, const uint32_t* y, int n ) {
+  uint32_t r = 0; int i = 0;
+
+#if defined( __ARM_NEON__ )
+  uint32x4_t a = vdupq_n_u32( 0 );
+
+  for( ; ( i + 4 ) <= n; i += 4 ) {
+    a = bits_weight4( a, veorq_u32( vld1q_u32( x + i ), vld1q_u32( y + i ) ) );
+  }
+
+  r = bits_sum4( a );
+#endif
+
+  for( ; i < n; i++ ) {
+    r += bits_weight1( x[ i ] ^ y[ i ] );
+  }
+
+  return r;
+}
+
+bool     bits_eq    ( const uint32_t* x, const uint32_t* y, int n ) {
+  uint32_t r = 0; int i = 0;
+
+#if defined( __ARM_NEON__ )
+  uint32x4_t a = vdupq_n_u32( 0 );
+
+  for( ; ( i + 4 ) <= n; i += 4 ) {
+    a = vorrq_u32( a, veorq_u32( vld1q_u32( x + i ), vld1q_u32( y + i ) ) );
+  }
+
+  uint32x2_t t = vorr_u32( vget_low_u32( a ), vget_high_u32( a ) );
+
+  r = vget_lane_u32( t, 0 ) | vget_lane_u32( t, 1 );
+#endif
+
+  for( ; i < n; i++ ) {
+    r |= x[ i ] ^ y[ i ];
+  }
+
+  return r == 0;
+}
+
+void     bits_and   ( uint32_t* r, const uint32_t* x, const uint32_t* y, int n ) {
+  int i = 0;
+
+#if defined( __ARM_NEON__ )
+  for( ; ( i + 4 ) <= n; i += 4 ) {
+    vst1q_u32( r + i, vandq_u32( vld1q_u32( x + i ), vld1q_u32( y + i ) ) );
+  }
+#endif
+
+  for( ; i < n; i++ ) {
+    r[ i ] = x[ i ] & y[ i ];
+  }
+}
+
+void     bits_xor   ( uint32_t* r, const uint32_t* x, const uint32_t* y, int n ) {
+  int i = 0;
+
+#if defined( __ARM_NEON__ )
+  for( ; ( i + 4 ) <= n; i += 4 ) {
+    vst1q_u32( r + i, veorq_u32( vld1q_u32( x + i ), vld1q_u32( y + i ) ) );
+  }
+#endif
+
+  for( ; i < n; i++ ) {
+    r[ i ] = x[ i ] ^ y[ i ];
+  }
+}
@@ -0,0 +1,39 @@
+/* Copyright (C) 2017 Daniel Page <csdsp@bristol.ac.uk>
+ *
+ * Use of this source code is restricted per the CC BY-NC-ND license, a copy of 
+ * which can be found via http://creativecommons.org (and should be included as 
+ * LICENSE.txt within the associated archive or repository).
+ */
+
+#ifndef __BITS_H
+#define __BITS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined( __ARM_NEON__ )
+#include <arm_neon.h>
+#endif
+
+/* The functions below operate on bit-vectors, i.e., arrays of n 32-bit
+ * words.  Where NEON is available (i.e., if built with -mfpu=neon), each
+ * processes 4 words at a time using 128-bit registers: the population
+ * count, for example, uses vcnt to count bits per byte, then pairwise
+ * additions to sum them.  Any remaining words (or every word, otherwise)
+ * are processed by a scalar fallback, which computes the same result.
+ */
+
+// return number of bits set in x, i.e., the population count or Hamming weight
+extern uint32_t bits_weight( const uint32_t* x, int n );
+// return number of bits which differ between x and y, i.e., the Hamming distance
+extern uint32_t bits_dist  ( const uint32_t* x, const uint32_t* y, int n );
+// return true iff. x and y are equal
+extern bool     bits_eq    ( const uint32_t* x, const uint32_t* y, int n );
+
+// compute r = x & y
+extern void     bits_and   ( uint32_t* r, const uint32_t* x, const uint32_t* y, int n );
+// compute r = x ^ y
+extern void     bits_xor   ( uint32_t* r, const uint32_t* x, const uint32_t* y, int n );
+
+#endif
@@ -8,19 +8,19 @@
 #include "console.h"
 
 /* The following functions are special-case versions of a) writing, and 
- * b) reading a string from the UART (the latter case returning once a 
- * carriage return character has been read, or a limit is reached).
+ * b) reading a string from the console (the latter case returning once a 
+ * carriage return character has been read, or a limit is reached).  Both
+ * are performed via the standard file descriptors, which the kernel sets
+ * up st. they refer to the UART the console is connected to.
  */
 
 void puts( char* x, int n ) {
-  for( int i = 0; i < n; i++ ) {
-    PL011_putc( UART1, x[ i ], true );
-  }
+  write( STDOUT_FILENO, x, n );
 }
 
 void gets( char* x, int n ) {
   for( int i = 0; i < n; i++ ) {
-    x[ i ] = PL011_getc( UART1, true );
+    read( STDIN_FILENO, &x[ i ], 1 );
 
     if( x[ i ] == '\x0A' ) {
       x[ i ] = '\x00'; break;
@@ -28,36 +28,82 @@ void gets( char* x, int n ) {
   }
 }
 
-/* Since we lack a *real* loader (as a result of also lacking a storage
- * medium to store program images), the following function approximates 
- * one: given a program name from the set of programs statically linked
- * into the kernel image, it returns a pointer to the entry point.
+/* Execute the pipeline of programs named by x[ 0 ], x[ 2 ], ..., where
+ * x[ 1 ], x[ 3 ], ... should each be "|".  Each program is spawned with
+ * the console standard streams temporarily replaced: standard input by
+ * the read end of the pipe from the previous program, and standard
+ * output by the write end of the pipe to the next.  The console keeps a
+ * copy of its own streams (in SAVED_IN and SAVED_OUT) to restore after
+ * each spawn, and closes its copy of each pipe end once it is passed on.
+ * Since spawn only shares the standard streams, no child inherits those
+ * copies, nor the read end of the pipe it writes to (which the console
+ * still holds while spawning it).
  */
 
-extern void main_P3(); 
-extern void main_P4(); 
-extern void main_P5();
-extern void main_P6();
-extern void main_dining();
+void pipeline( char* x[], int n ) {
+  int in = -1; // read end of pipe from previous program
 
-void* load( char* x ) {
-  if     ( 0 == strcmp( x, "P3" ) ) {
-    return &main_P3;
-  }
-  else if( 0 == strcmp( x, "P4" ) ) {
-    return &main_P4;
+  dup2( STDIN_FILENO,  SAVED_IN  );
+  dup2( STDOUT_FILENO, SAVED_OUT );
+
+  for( int i = 0; i < n; i += 2 ) {
+    bool last = ( i + 1 ) >= n; int fd[ 2 ]; char* argv[] = { x[ i ], NULL };
+
+    if( !last && ( 0 != strcmp( x[ i + 1 ], "|" ) || ( i + 2 ) >= n ) ) {
+      puts( "unknown command\n", 16 ); break;
+    }
+    if( !last && pipe( fd ) < 0 ) {
+      puts( "too many pipes\n",  15 ); break;
+    }
+
+    if( in != -1 ) {
+      dup2( in,      STDIN_FILENO  ); close( in ); in = -1;
+    }
+    if( !last    ) {
+      dup2( fd[ 1 ], STDOUT_FILENO ); close( fd[ 1 ] ); in = fd[ 0 ];
+    }
+
+    if( spawn( x[ i ], -1, argv ) < 0 ) {
+      write( STDERR_FILENO, "unknown program\n", 16 );
+    }
+
+    dup2( SAVED_IN,  STDIN_FILENO  );
+    dup2( SAVED_OUT, STDOUT_FILENO );
   }
-  else if( 0 == strcmp( x, "P5" ) ) {
-    return &main_P5;
+
+  if( in != -1 ) {
+    close( in );
   }
-  else if( 0 == strcmp( x, "P6" ) ) {
-    return &main_P6;
+
+  close( SAVED_IN  );
+  close( SAVED_OUT );
+}
+
+/* Write the accounting of each process (then the idle process of each
+ * CPU, i.e., idle time), per getstats; cycles and instructions are in
+ * thousands.
+ */
+
+static void top_row( const char* name, int x, stats_t* s ) {
+  printf( "%s%-3d %10u %10u %10u %8u %8u %6u\n", name, x,
+          ( uint32_t )( s->user   / 1000 ),
+          ( uint32_t )( s->sys    / 1000 ),
+          ( uint32_t )( s->instrs / 1000 ), s->switches, s->syscalls, s->faults );
+}
+
+void top() {
+  stats_t s;
+
+  printf( "PID      USER(K)     SYS(K)   INSTR(K)   SWITCH  SYSCALL  FAULT\n" );
+
+  for( int pid = 0; pid < TOP_PIDS; pid++ ) {
+    if( getstats( pid, &s ) == 0 ) top_row( " ", pid, &s );
   }
-  else if( 0 == strcmp( x, "dining" ) ) {
-    return &main_dining;
+  for( int c = 0; c < TOP_CPUS; c++ ) {
+    if( getstats( -1 - c, &s ) == 0 ) top_row( "I", c, &s );
   }
 
-  return NULL;
+  fflush( stdout );
 }
 
 /* The behaviour of a console process can be summarised as an infinite 
@@ -69,16 +115,25 @@ void* load( char* x ) {
  *
  * As is, the console only recognises the following commands:
  *
- * a. execute <program name>
+ * a. execute <program name> [ | <program name> ... ]
  *
- *    This command will use fork to create a new process; the parent
- *    (i.e., the console) will continue as normal, whereas the child
- *    uses exec to replace the process image and thereby execute a
- *    different (named) program.  For example,
+ *    This command will use spawn to create a new process executing a
+ *    different (named) program, whereas the console will continue as
+ *    normal.  For example,
  *    
  *    execute P3
  *
- *    would execute the user program named P3.
+ *    would execute the user program named P3.  A program is either
+ *    linked into the kernel, and registered by name (see PROGRAM in
+ *    libc.h), or else loaded from the disk, st. it can be built and
+ *    added separately (see kernel/image.h).  Several
+ *    programs can be connected into a pipeline, st. the standard output
+ *    of each one is piped into the standard input of the next.  For
+ *    example,
+ *
+ *    execute P3 | cat
+ *
+ *    would execute P3 and cat, with the output of P3 read by cat.
  *
  * b. terminate <process ID> 
  *
@@ -90,9 +145,54 @@ void* load( char* x ) {
  *    terminate 3
  *
  *    would terminate the process whose PID is 3.
+ *
+ * c. slice <process ID> <cycles>
+ *
+ *    This command uses sched_setslice to set the time slice of a
+ *    specific process (identified via the PID provided), or restore
+ *    the default computed per scheduling class iff. the number of
+ *    cycles is 0.  For example,
+ *
+ *    slice 3 500000
+ *
+ *    would let the process whose PID is 3 (e.g., executing a CPU-bound
+ *    program such as P3) execute for up to 500 ms once dispatched.
+ *
+ * d. top
+ *
+ *    This command uses getstats to write how many cycles each process
+ *    has spent executing in USR mode and in the kernel, plus how many
+ *    instructions it has executed, context switches to it, system calls
+ *    and page faults it has made, st. it is clear where time goes.
+ *
+ * e. trace start | stop | dump
+ *
+ *    This command uses trace to start or stop recording kernel events
+ *    (e.g., context switches, interrupts and system calls), or to dump
+ *    those recorded to UART3, from which device/trace.py can produce a
+ *    timeline.  The dump is written in the background: another cannot be
+ *    requested until it has been.
+ *
+ * f. prof start [cycles] | stop | dump
+ *
+ *    This command uses prof to start sampling what each CPU executes
+ *    every so many cycles (at least 100, or per the default iff. none
+ *    are given), to stop doing so, or to dump those samples taken to
+ *    UART3, from which device/prof.py can produce folded stacks (e.g.,
+ *    for a flame graph).  As per trace, the dump is written in the
+ *    background.
  */
 
 void main_console() {
+  /* Input is handled with bounded latency, i.e., the console reserves
+   * CONSOLE_RUNTIME cycles every CONSOLE_PERIOD under SCHED_EDF: once a
+   * command is typed, it preempts whatever else is executing (e.g., a
+   * CPU-bound program it executed before) rather than waiting for it.
+   */
+
+  sched_attr_t attr = { SCHED_EDF, 0, CONSOLE_RUNTIME, CONSOLE_PERIOD, CONSOLE_PERIOD };
+  sched_setattr( 0, &attr );
+
   while( 1 ) {
     char cmd[ MAX_CMD_CHARS ];
 
@@ -104,27 +204,50 @@ void main_console() {
 
     int cmd_argc = 0; char* cmd_argv[ MAX_CMD_ARGS ];
 
-    for( char* t = strtok( cmd, " " ); t != NULL; t = strtok( NULL, " " ) ) {
+    for( char* t = strtok( cmd, " " ); t != NULL && cmd_argc < MAX_CMD_ARGS; t = strtok( NULL, " " ) ) {
       cmd_argv[ cmd_argc++ ] = t;
     }
 
     // step 3: execute command.
 
     if     ( 0 == strcmp( cmd_argv[ 0 ], "execute"   ) ) {
-      void* addr = load( cmd_argv[ 1 ] );
-
-      if( addr != NULL ) {
-        if( 0 == fork() ) {
-          exec( addr );
-        }
-      }
-      else {
-        puts( "unknown program\n", 16 );
-      }
+      pipeline( &cmd_argv[ 1 ], cmd_argc - 1 );
     } 
     else if( 0 == strcmp( cmd_argv[ 0 ], "terminate" ) ) {
       kill( atoi( cmd_argv[ 1 ] ), SIG_TERM );
     } 
+    else if( 0 == strcmp( cmd_argv[ 0 ], "slice"     ) && cmd_argc == 3 ) {
+      if( sched_setslice( atoi( cmd_argv[ 1 ] ), atoi( cmd_argv[ 2 ] ) ) < 0 ) {
+        puts( "invalid slice\n", 14 );
+      }
+    }
+    else if( 0 == strcmp( cmd_argv[ 0 ], "top"       ) ) {
+      top();
+    }
+    else if( 0 == strcmp( cmd_argv[ 0 ], "trace"     ) && cmd_argc == 2 ) {
+      int x = ( 0 == strcmp( cmd_argv[ 1 ], "start" ) ) ? TRACE_START :
+              ( 0 == strcmp( cmd_argv[ 1 ], "stop"  ) ) ? TRACE_STOP  :
+              ( 0 == strcmp( cmd_argv[ 1 ], "dump"  ) ) ? TRACE_DUMP  : -1;
+
+      if     ( x < 0          ) {
+        puts( "unknown command\n", 16 );
+      }
+      else if( trace( x ) < 0 ) {
+        puts( "trace busy\n", 11 );
+      }
+    }
+    else if( 0 == strcmp( cmd_argv[ 0 ], "prof"      ) && cmd_argc >= 2 ) {
+      int x = ( 0 == strcmp( cmd_argv[ 1 ], "start" ) ) ? PROF_START :
+              ( 0 == strcmp( cmd_argv[ 1 ], "stop"  ) ) ? PROF_STOP  :
+              ( 0 == strcmp( cmd_argv[ 1 ], "dump"  ) ) ? PROF_DUMP  : -1;
+
+      if     ( x < 0 ) {
+        puts( "unknown command\n", 16 );
+      }
+      else if( prof( x, ( cmd_argc == 3 ) ? atoi( cmd_argv[ 2 ] ) : 0 ) < 0 ) {
+        puts( "prof failed\n", 12 );
+      }
+    }
     else {
       puts( "unknown command\n", 16 );
     }
@@ -132,3 +255,5 @@ void main_console() {
 
   exit( EXIT_SUCCESS );
 }
+
+PROGRAM( "console", main_console, 0x0C00, 1 );
@@ -14,11 +14,18 @@
 
 #include <string.h>
 
-#include "PL011.h"
-
 #include "libc.h"
 
 #define MAX_CMD_CHARS ( 1024 )
-#define MAX_CMD_ARGS  (    2 )
+#define MAX_CMD_ARGS  (    8 )
+
+#define SAVED_IN      (    6 ) // file descriptor standard input  is saved in during a pipeline
+#define SAVED_OUT     (    7 ) // file descriptor standard output is saved in during a pipeline
+
+#define CONSOLE_RUNTIME (  5000 ) // runtime  reserved per period (in cycles, i.e., 5 ms), under SCHED_EDF
+#define CONSOLE_PERIOD  ( 50000 ) // period,  and deadline        (in cycles, i.e., 50 ms)
+
+#define TOP_PIDS      (   32 ) // number of PIDs top tries, i.e., at least the number of PCBs
+#define TOP_CPUS      (    4 ) // number of CPUs top tries
 
 #endif
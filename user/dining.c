@@ -39,13 +39,11 @@ int mod( int x, int m ) {
 }
 
 // While we don't own chopsticks, get chopsticks from others only if they're dirty
-void request( int id, char id_c[2], chopstick* l, chopstick* r ) {
+void request( int id, chopstick* l, chopstick* r ) {
   // A philosopher must check if they're the owner of the chopstick (owner_id) and they've locked it (mutex == 0)
   while( id != l->owner_id || l->mutex == 1 || id != r->owner_id || r->mutex == 1 ) {
     if( id != l->owner_id && l->dirty ) { // If not owner and not locked in
-      write( STDOUT_FILENO, "Philosopher ", 12 );
-      write( STDOUT_FILENO, id_c, 2 );
-      write( STDOUT_FILENO, " wants left\n", 12 );
+      printf( "Philosopher %d wants left\n", id );
 
       // Wait until chopstick available to take
       sem_wait( &l->mutex );
@@ -54,15 +52,11 @@ void request( int id, char id_c[2], chopstick* l, chopstick* r ) {
       l->dirty    = false;
       l->owner_id = id;
 
-      write( STDOUT_FILENO, "Philosopher ", 12 );
-      write( STDOUT_FILENO, id_c, 2 );
-      write( STDOUT_FILENO, " gets left\n", 11 );
+      printf( "Philosopher %d gets left\n", id );
     }
 
     if( id != r->owner_id && r->dirty ) {
-      write( STDOUT_FILENO, "Philosopher ", 12 );
-      write( STDOUT_FILENO, id_c, 2 );
-      write( STDOUT_FILENO, " wants right\n", 13 );
+      printf( "Philosopher %d wants right\n", id );
       
       // Wait until chopstick available to take
       sem_wait( &r->mutex );
@@ -71,42 +65,34 @@ void request( int id, char id_c[2], chopstick* l, chopstick* r ) {
       r->dirty    = false;
       r->owner_id = id;
 
-      write( STDOUT_FILENO, "Philosopher ", 12 );
-      write( STDOUT_FILENO, id_c, 2 );
-      write( STDOUT_FILENO, " gets right\n", 12 );
+      printf( "Philosopher %d gets right\n", id );
     }
   }
 }
 
 // Thread is idle (Can give away resources)
-void thinking( char id_c[2] ) {
-  write( STDOUT_FILENO, "Philosopher ", 12 );
-  write( STDOUT_FILENO, id_c, 2 );
-  write( STDOUT_FILENO, " is thinking\n", 13 );
+void thinking( int id ) {
+  printf( "Philosopher %d is thinking\n", id );
 
   // "Think"
-  sleep( atoi( id_c ) + 1 );
+  sleep( id + 1 );
 }
 
 // Thread wanting to execute (Needs resources)
-void hungry( int id, char id_c[2], chopstick* l, chopstick* r ) {
-  write( STDOUT_FILENO, "Philosopher ", 12 );
-  write( STDOUT_FILENO, id_c, 2 );
-  write( STDOUT_FILENO, " is hungry\n", 11 );
+void hungry( int id, chopstick* l, chopstick* r ) {
+  printf( "Philosopher %d is hungry\n", id );
 
   // Request for chopsticks (resources) to eat
-  request( id, id_c, l, r );
+  request( id, l, r );
 }
 
 // Thread execute (Has resources)
 // After eating, they're still the owner of the chopsticks (owner_id) but they can be given away (mutex == 1)
-void eating( char id_c[2], chopstick* l, chopstick* r ) {
-  write( STDOUT_FILENO, "Philosopher ", 12 );
-  write( STDOUT_FILENO, id_c, 2 );
-  write( STDOUT_FILENO, " is eating\n", 11 );
+void eating( int id, chopstick* l, chopstick* r ) {
+  printf( "Philosopher %d is eating\n", id );
 
   // "Eat"
-  sleep( atoi( id_c ) + 1 );
+  sleep( id + 1 );
 
   // Set chopsticks as dirty and indicate to neighbours the chopsticks can be taken from this philosopher
   l->dirty = true;
@@ -115,53 +101,68 @@ void eating( char id_c[2], chopstick* l, chopstick* r ) {
   sem_post( &r->mutex );
 }
 
+/* Each philosopher is a thread executing philosopher( &seats[ i ] ) for
+ * some i; since threads share an address space, the chopsticks are
+ * simply a (local) array in main_dining.
+ */
+
+void philosopher( void* x ) {
+  // Attributes of philosopher
+  int id = ( ( seat* )( x ) )->id;
+  chopstick* chopsticks = ( ( seat* )( x ) )->chopsticks; // Chopsticks array
+  chopstick* l;
+  chopstick* r;
+
+  // Set up the table
+  // 1st philosopher has 2 chopsticks, last philosopher has no chopsticks
+  // Every other philosopher has 1 chopstick on their right
+  int num;
+  num = mod( id - 1, PHILOSOPHERS );
+  l = &chopsticks[ id ];
+  if( id < num ) {
+    l->mutex    = 0;
+    l->owner_id = id;
+    l->dirty    = true;
+  }
+
+  num = mod( id + 1, PHILOSOPHERS );
+  r = &chopsticks[ num ];
+  if( id < num ) {
+    r->mutex    = 0;
+    r->owner_id = id;
+    r->dirty    = true;
+  }
+
+  // Make sure every philosopher sets up their part of the table before dining
+  yield();
+
+  // Forever cycle between thinking, hungry and eating.
+  while( 1 ) {
+    thinking( id );
+    hungry( id, l, r );
+    eating( id, l, r );
+  }
+}
+
 void main_dining() {
-  // Open a shm region for chopsticks
-  int c_fd = shm_open( sizeof( chopstick ) * PHILOSOPHERS );
+  chopstick chopsticks[ PHILOSOPHERS ]; seat seats[ PHILOSOPHERS ]; int tids[ PHILOSOPHERS ];
+
+  memset( chopsticks, 0, sizeof( chopsticks ) );
 
   // Create 16 philosophers
   for( int i = PHILOSOPHERS - 1; i >= 0; i-- ) {
-    if( 0 == fork() ) {
-      // Attributes of philosopher
-      int id = i;
-      char id_c[ 2 ]; // ID in char form
-      itoa( id_c, id );
-      chopstick* l;
-      chopstick* r;
-
-      chopstick* chopsticks = mmap( c_fd ); // Chopsticks array
-
-      // Set up the table
-      // 1st philosopher has 2 chopsticks, last philosopher has no chopsticks
-      // Every other philosopher has 1 chopstick on their right
-      int num;
-      num = mod( id - 1, PHILOSOPHERS );
-      l = &chopsticks[ id ];
-      if( id < num ) {
-        l->mutex    = 0;
-        l->owner_id = id;
-        l->dirty    = true;
-      }
-
-      num = mod( id + 1, PHILOSOPHERS );
-      r = &chopsticks[ num ];
-      if( id < num ) {
-        r->mutex    = 0;
-        r->owner_id = id;
-        r->dirty    = true;
-      }
-
-      // Make sure every philosopher sets up their part of the table before dining
-      yield();
-
-      // Forever cycle between thinking, hungry and eating.
-      while( 1 ) {
-        thinking( id_c );
-        hungry( id, id_c, l, r );
-        eating( id_c, l, r );
-      }
-    }
+    seats[ i ].id         = i;
+    seats[ i ].chopsticks = chopsticks;
+
+    tids[ i ] = thread_create( &philosopher, &seats[ i ] );
+  }
+
+  // Wait for the philosophers (i.e., forever), since they use the stack of this thread
+  for( int i = PHILOSOPHERS - 1; i >= 0; i-- ) {
+    thread_join( tids[ i ] );
   }
 
   exit( EXIT_SUCCESS );
-}
\ No newline at end of file
+}
+
+PROGRAM( "dining", main_dining, 0x0400, 1 );
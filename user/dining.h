@@ -18,4 +18,10 @@ typedef struct {
   int mutex;    // lock for chopstick
 } chopstick;
 
+// Place at the table, i.e., argument of each philosopher thread
+typedef struct {
+  int id;                 // ID of philosopher
+  chopstick* chopsticks;  // chopsticks on the table
+} seat;
+
 #endif
@@ -0,0 +1,65 @@
+/* Copyright (C) 2017 Daniel Page <csdsp@bristol.ac.uk>
+ *
+ * Use of this source code is restricted per the CC BY-NC-ND license, a copy of 
+ * which can be found via http://creativecommons.org (and should be included as 
+ * LICENSE.txt within the associated archive or repository).
+ */
+
+#include "gcd.h"
+
+static uint8_t           gcd_table[ GCD_N ][ GCD_N ]; // memoised GCD of ( GCD_LO + i, GCD_LO + j ), which is < GCD_HI
+static volatile uint32_t gcd_ready = 0;               // table is filled
+
+uint32_t gcd_binary ( uint32_t x, uint32_t y ) {
+  if( x == 0 || y == 0 ) {
+    return x | y;
+  }
+
+  // Remove common factors of 2 (restored at the end), then make x odd
+  int k = __builtin_ctz( x | y );
+
+  x >>= __builtin_ctz( x );
+
+  // Invariant: x is odd; make y odd, then subtract the lesser from the greater (st. y is even again) until y = 0
+  while( y != 0 ) {
+    y >>= __builtin_ctz( y );
+
+    if( x > y ) {
+      uint32_t t = x; x = y; y = t;
+    }
+
+    y -= x;
+  }
+
+  return x << k;
+}
+
+void     gcd_batch  ( uint32_t* r, const uint32_t* x, const uint32_t* y, int n ) {
+  bool ready = gcd_ready;
+
+  for( int i = 0; i < n; i++ ) {
+    uint32_t a = x[ i ] - GCD_LO, b = y[ i ] - GCD_LO; // i.e., >= GCD_N iff. x[ i ] or y[ i ] is out of range, since unsigned
+
+    r[ i ] = ( ready && a < GCD_N && b < GCD_N ) ? gcd_table[ a ][ b ] : gcd_binary( x[ i ], y[ i ] );
+  }
+}
+
+void     gcd_memoise() {
+  if( gcd_ready ) {
+    return;
+  }
+
+  /* Another process may fill the table concurrently, but each writes the
+   * same values; the table must be complete before it is marked ready.
+   */
+
+  for( int i = 0; i < GCD_N; i++ ) {
+    for( int j = 0; j <= i; j++ ) {
+      gcd_table[ i ][ j ] = gcd_table[ j ][ i ] = gcd_binary( GCD_LO + i, GCD_LO + j );
+    }
+  }
+
+  asm volatile( "dmb" ::: "memory" );
+
+  gcd_ready = 1;
+}
@@ -0,0 +1,39 @@
+/* Copyright (C) 2017 Daniel Page <csdsp@bristol.ac.uk>
+ *
+ * Use of this source code is restricted per the CC BY-NC-ND license, a copy of 
+ * which can be found via http://creativecommons.org (and should be included as 
+ * LICENSE.txt within the associated archive or repository).
+ */
+
+#ifndef __GCD_H
+#define __GCD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* The functions below compute the Greatest Common Divisor (GCD) using
+ * Stein's binary algorithm, i.e., iteratively, by shifting out factors
+ * of 2 (using ctz, which the Cortex-A8 computes as rbit then clz) and
+ * subtracting, rather than dividing or recursing.  Note that
+ *
+ * - gcd_batch computes the GCD of each pair in arrays x and y, and
+ * - each pair in [GCD_LO, GCD_HI)^2 can be memoised in a table: the
+ *   table is static, and so, since programs linked into the kernel image
+ *   share static data, is shared by every process executing them.  It
+ *   is filled once, by whichever process first calls gcd_memoise, then
+ *   only read; a process which finds it ready reuses it as is.
+ */
+
+#define GCD_LO ( 1 << 4 )
+#define GCD_HI ( 1 << 8 )
+#define GCD_N  ( GCD_HI - GCD_LO ) // i.e., the table is 240 x 240 entries
+
+// return GCD of x and y (where gcd( x, 0 ) = x)
+extern uint32_t gcd_binary ( uint32_t x, uint32_t y );
+// compute r[ i ] = GCD of x[ i ] and y[ i ] for 0 <= i < n, via the memoised table iff. ready
+extern void     gcd_batch  ( uint32_t* r, const uint32_t* x, const uint32_t* y, int n );
+// fill memoised table, iff. not ready already
+extern void     gcd_memoise();
+
+#endif
@@ -62,38 +62,173 @@ void yield() {
 }
 
 int write( int fd, const void* x, size_t n ) {
+  int r; size_t t = 0;
+
+  // The kernel may queue fewer than n bytes (e.g., if n exceeds the space
+  // it has to buffer them), so keep writing until every byte is written.
+
+  do {
+    asm volatile( "mov r0, %2 \n" // assign r0 = fd
+                  "mov r1, %3 \n" // assign r1 =  x
+                  "mov r2, %4 \n" // assign r2 =  n
+                  "svc %1     \n" // make system call SYS_WRITE
+                  "mov %0, r0 \n" // assign r  = r0
+                : "=r" (r) 
+                : "I" (SYS_WRITE), "r" (fd), "r" (( const uint8_t* )( x ) + t), "r" (n - t)
+                : "r0", "r1", "r2" );
+
+    if( r < 0 ) {
+      return r;
+    }
+
+    t += r;
+  } while( t < n );
+
+  return t;
+}
+
+int  read( int fd,       void* x, size_t n ) {
   int r;
 
   asm volatile( "mov r0, %2 \n" // assign r0 = fd
                 "mov r1, %3 \n" // assign r1 =  x
                 "mov r2, %4 \n" // assign r2 =  n
-                "svc %1     \n" // make system call SYS_WRITE
+                "svc %1     \n" // make system call SYS_READ
                 "mov %0, r0 \n" // assign r  = r0
               : "=r" (r) 
-              : "I" (SYS_WRITE), "r" (fd), "r" (x), "r" (n)
+              : "I" (SYS_READ),  "r" (fd), "r" (x), "r" (n) 
               : "r0", "r1", "r2" );
 
   return r;
 }
 
-int  read( int fd,       void* x, size_t n ) {
+int writev( int fd, const iovec_t* iov, int n ) {
+  int r;
+
+  asm volatile( "mov r0, %2 \n" // assign r0 =  fd
+                "mov r1, %3 \n" // assign r1 = iov
+                "mov r2, %4 \n" // assign r2 =   n
+                "svc %1     \n" // make system call SYS_WRITEV
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r) 
+              : "I" (SYS_WRITEV), "r" (fd), "r" (iov), "r" (n)
+              : "r0", "r1", "r2" );
+
+  if( r < 0 ) {
+    return r;
+  }
+
+  // The kernel may queue fewer bytes than requested (e.g., if there are too
+  // many to buffer), so write whatever remains buffer by buffer.
+
+  int t = r;
+
+  for( int i = 0; i < n; i++ ) {
+    if( r >= iov[ i ].iov_len ) {
+      r -= iov[ i ].iov_len; continue;
+    }
+
+    int k = write( fd, ( const uint8_t* )( iov[ i ].iov_base ) + r, iov[ i ].iov_len - r );
+
+    if( k < 0 ) {
+      return k;
+    }
+
+    t += k; r = 0;
+  }
+
+  return t;
+}
+
+int  readv( int fd, const iovec_t* iov, int n ) {
+  int r;
+
+  asm volatile( "mov r0, %2 \n" // assign r0 =  fd
+                "mov r1, %3 \n" // assign r1 = iov
+                "mov r2, %4 \n" // assign r2 =   n
+                "svc %1     \n" // make system call SYS_READV
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r) 
+              : "I" (SYS_READV), "r" (fd), "r" (iov), "r" (n)
+              : "r0", "r1", "r2" );
+
+  return r;
+}
+
+int  open( const char* x ) {
+  int r;
+
+  asm volatile( "mov r0, %2 \n" // assign r0 =  x
+                "svc %1     \n" // make system call SYS_OPEN
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r) 
+              : "I" (SYS_OPEN), "r" (x)
+              : "r0" );
+
+  return r;
+}
+
+int close( int fd ) {
   int r;
 
   asm volatile( "mov r0, %2 \n" // assign r0 = fd
-                "mov r1, %3 \n" // assign r1 =  x
-                "mov r2, %4 \n" // assign r2 =  n
-                "svc %1     \n" // make system call SYS_READ
+                "svc %1     \n" // make system call SYS_CLOSE
                 "mov %0, r0 \n" // assign r  = r0
               : "=r" (r) 
-              : "I" (SYS_READ),  "r" (fd), "r" (x), "r" (n) 
+              : "I" (SYS_CLOSE), "r" (fd)
+              : "r0" );
+
+  return r;
+}
+
+int lseek( int fd, int x, int whence ) {
+  int r;
+
+  asm volatile( "mov r0, %2 \n" // assign r0 =     fd
+                "mov r1, %3 \n" // assign r1 =      x
+                "mov r2, %4 \n" // assign r2 = whence
+                "svc %1     \n" // make system call SYS_LSEEK
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r) 
+              : "I" (SYS_LSEEK), "r" (fd), "r" (x), "r" (whence)
               : "r0", "r1", "r2" );
 
   return r;
 }
 
+int pipe( int fd[ 2 ] ) {
+  int r;
+
+  asm volatile( "mov r0, %2 \n" // assign r0 = fd
+                "svc %1     \n" // make system call SYS_PIPE
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r) 
+              : "I" (SYS_PIPE), "r" (fd)
+              : "r0", "memory" );
+
+  return r;
+}
+
+int dup2( int x, int y ) {
+  int r;
+
+  asm volatile( "mov r0, %2 \n" // assign r0 =  x
+                "mov r1, %3 \n" // assign r1 =  y
+                "svc %1     \n" // make system call SYS_DUP2
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r) 
+              : "I" (SYS_DUP2), "r" (x), "r" (y)
+              : "r0", "r1" );
+
+  return r;
+}
+
 int  fork() {
   int r;
 
+  // Flush first, st. child and parent don't both write what is buffered
+  fflush( stdout ); fflush( stderr );
+
   asm volatile( "svc %1     \n" // make system call SYS_FORK
                 "mov %0, r0 \n" // assign r  = r0 
               : "=r" (r) 
@@ -104,6 +239,8 @@ int  fork() {
 }
 
 void exit( int x ) {
+  fflush( stdout ); fflush( stderr );
+
   asm volatile( "mov r0, %1 \n" // assign r0 =  x
                 "svc %0     \n" // make system call SYS_EXIT
               :
@@ -113,14 +250,70 @@ void exit( int x ) {
   return;
 }
 
-void exec( const void* x ) {
-  asm volatile( "mov r0, %1 \n" // assign r0 = x
-                "svc %0     \n" // make system call SYS_EXEC
-              :
+int  exec( const char* x ) {
+  int r;
+
+  fflush( stdout ); fflush( stderr );
+
+  asm volatile( "mov r0, %2 \n" // assign r0 = x
+                "svc %1     \n" // make system call SYS_EXEC
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r)
               : "I" (SYS_EXEC), "r" (x)
+              : "r0", "memory" );
+
+  return r;
+}
+
+int  spawn( const char* x, int priority, char* const argv[] ) {
+  int r;
+
+  asm volatile( "mov r0, %2 \n" // assign r0 = x
+                "mov r1, %3 \n" // assign r1 = priority
+                "mov r2, %4 \n" // assign r2 = argv
+                "svc %1     \n" // make system call SYS_SPAWN
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r)
+              : "I" (SYS_SPAWN), "r" (x), "r" (priority), "r" (argv)
+              : "r0", "r1", "r2" );
+
+  return r;
+}
+
+/* A thread is entered here rather than at fn itself, st. returning from
+ * fn terminates the thread.
+ */
+
+static void thread_start( void ( *fn )( void* ), void* x ) {
+  fn( x ); exit( EXIT_SUCCESS );
+}
+
+int  thread_create( void ( *fn )( void* ), void* x ) {
+  int r;
+
+  asm volatile( "mov r0, %2 \n" // assign r0 = entry
+                "mov r1, %3 \n" // assign r1 = fn
+                "mov r2, %4 \n" // assign r2 = x
+                "svc %1     \n" // make system call SYS_THREAD_CREATE
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r)
+              : "I" (SYS_THREAD_CREATE), "r" (&thread_start), "r" (fn), "r" (x)
+              : "r0", "r1", "r2" );
+
+  return r;
+}
+
+int  thread_join( int t ) {
+  int r;
+
+  asm volatile( "mov r0, %2 \n" // assign r0 = t
+                "svc %1     \n" // make system call SYS_THREAD_JOIN
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r)
+              : "I" (SYS_THREAD_JOIN), "r" (t)
               : "r0" );
 
-  return;
+  return r;
 }
 
 int  kill( int pid, int x ) {
@@ -148,6 +341,115 @@ void nice( int pid, int x ) {
   return;
 }
 
+int  sched_setclass( int pid, int x ) {
+  int r;
+
+  asm volatile( "mov r0, %2 \n" // assign r0 =  pid
+                "mov r1, %3 \n" // assign r1 =    x
+                "svc %1     \n" // make system call SYS_SCHED_SETCLASS
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r)
+              : "I" (SYS_SCHED_SETCLASS), "r" (pid), "r" (x)
+              : "r0", "r1" );
+
+  return r;
+}
+
+int  sched_setattr( int pid, const sched_attr_t* x ) {
+  int r;
+
+  asm volatile( "mov r0, %2 \n" // assign r0 =  pid
+                "mov r1, %3 \n" // assign r1 =    x
+                "svc %1     \n" // make system call SYS_SCHED_SETATTR
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r)
+              : "I" (SYS_SCHED_SETATTR), "r" (pid), "r" (x)
+              : "r0", "r1" );
+
+  return r;
+}
+
+int  sched_setslice( int pid, uint32_t x ) {
+  int r;
+
+  asm volatile( "mov r0, %2 \n" // assign r0 =  pid
+                "mov r1, %3 \n" // assign r1 =    x
+                "svc %1     \n" // make system call SYS_SCHED_SETSLICE
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r)
+              : "I" (SYS_SCHED_SETSLICE), "r" (pid), "r" (x)
+              : "r0", "r1" );
+
+  return r;
+}
+
+int  sched_setquantum( int c, uint32_t x ) {
+  int r;
+
+  asm volatile( "mov r0, %2 \n" // assign r0 =    c
+                "mov r1, %3 \n" // assign r1 =    x
+                "svc %1     \n" // make system call SYS_SCHED_SETQUANTUM
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r)
+              : "I" (SYS_SCHED_SETQUANTUM), "r" (c), "r" (x)
+              : "r0", "r1" );
+
+  return r;
+}
+
+int  getstats( int pid, stats_t* x ) {
+  int r;
+
+  asm volatile( "mov r0, %2 \n" // assign r0 =  pid
+                "mov r1, %3 \n" // assign r1 =    x
+                "svc %1     \n" // make system call SYS_GETSTATS
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r)
+              : "I" (SYS_GETSTATS), "r" (pid), "r" (x)
+              : "r0", "r1", "memory" );
+
+  return r;
+}
+
+int  trace( int x ) {
+  int r;
+
+  asm volatile( "mov r0, %2 \n" // assign r0 =    x
+                "svc %1     \n" // make system call SYS_TRACE
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r)
+              : "I" (SYS_TRACE), "r" (x)
+              : "r0" );
+
+  return r;
+}
+
+int  prof( int x, uint32_t y ) {
+  int r;
+
+  asm volatile( "mov r0, %2 \n" // assign r0 =    x
+                "mov r1, %3 \n" // assign r1 =    y
+                "svc %1     \n" // make system call SYS_PROF
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r)
+              : "I" (SYS_PROF), "r" (x), "r" (y)
+              : "r0", "r1" );
+
+  return r;
+}
+
+pid_t getpid() {
+  pid_t r;
+
+  asm volatile( "svc %1     \n" // make system call SYS_GETPID
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r)
+              : "I" (SYS_GETPID)
+              : "r0" );
+
+  return r;
+}
+
 int shm_open( uint32_t size ) {
   int r;
 
@@ -190,6 +492,18 @@ void sleep ( int s ) {
   }
 }
 
+uint32_t cycles() {
+  uint32_t r;
+
+  asm volatile( "svc %1     \n" // make system call SYS_CYCLES
+                "mov %0, r0 \n" // assign r  = r0
+              : "=r" (r)
+              : "I" (SYS_CYCLES)
+              : "r0" );
+
+  return r;
+}
+
 void sem_post ( const void * x ) {
   asm volatile( "ldrex     r1, [ %0 ] \n" // s' = MEM[ &s ]
                 "add   r1, r1, #1     \n" // s' = s'+ 1
@@ -221,3 +535,219 @@ void sem_wait( const void * x ) {
 
   return;
 }
+
+/* The TLS area reserved by the kernel (whose address is held in the read-
+ * only TPIDRURO register) is zero when a process starts: the standard
+ * streams are therefore initialised on first use.
+ */
+
+typedef struct {
+  bool  init;         // initialised?
+  FILE  stdio[ 2 ];   // stdout and stderr
+} tls_t;              // must fit within PROC_TLS bytes
+
+static tls_t* tls() {
+  tls_t* r;
+
+  asm volatile( "mrc p15, 0, %0, c13, c0, 3 \n" // assign r = TPIDRURO
+              : "=r" (r) );
+
+  return r;
+}
+
+FILE* stdio( int fd ) {
+  tls_t* t = tls();
+
+  if( !t->init ) {
+    t->stdio[ 0 ].fd   = STDOUT_FILENO; t->stdio[ 0 ].mode = _IOLBF; t->stdio[ 0 ].n = 0;
+    t->stdio[ 1 ].fd   = STDERR_FILENO; t->stdio[ 1 ].mode = _IONBF; t->stdio[ 1 ].n = 0;
+    t->init = true;
+  }
+
+  return &t->stdio[ ( fd == STDERR_FILENO ) ? 1 : 0 ];
+}
+
+int setvbuf( FILE* f, int mode ) {
+  if( fflush( f ) == EOF ) {
+    return EOF;
+  }
+
+  f->mode = mode;
+
+  return 0;
+}
+
+int fflush( FILE* f ) {
+  if( f->n > 0 ) {
+    int r = write( f->fd, f->buf, f->n ); f->n = 0;
+
+    if( r < 0 ) {
+      return EOF;
+    }
+  }
+
+  return 0;
+}
+
+// append byte c to the buffer of stream f, flushing first iff. it is full
+static int fputb( FILE* f, char c ) {
+  if( ( f->n == BUFSIZ ) && ( fflush( f ) == EOF ) ) {
+    return EOF;
+  }
+
+  f->buf[ f->n++ ] = c;
+
+  return ( uint8_t )( c );
+}
+
+// at the end of a call that wrote to stream f, flush iff. the buffering mode demands it
+static int fdone( FILE* f ) {
+  if( f->mode == _IOLBF ) {
+    for( size_t i = 0; i < f->n; i++ ) {
+      if( f->buf[ i ] == '\n' ) return fflush( f );
+    }
+  }
+  else if( f->mode == _IONBF ) {
+    return fflush( f );
+  }
+
+  return 0;
+}
+
+int fputc( int c, FILE* f ) {
+  if( ( fputb( f, c ) == EOF ) || ( fdone( f ) == EOF ) ) {
+    return EOF;
+  }
+
+  return ( uint8_t )( c );
+}
+
+int fputs( const char* x, FILE* f ) {
+  size_t n = 0;
+
+  while( x[ n ] != '\x00' ) {
+    n++;
+  }
+
+  return ( fwrite( x, 1, n, f ) == n ) ? 0 : EOF;
+}
+
+size_t fwrite( const void* x, size_t size, size_t n, FILE* f ) {
+  const char* p = x; size_t len = size * n;
+
+  // If x won't fit into the buffer, write what is buffered *and* x in one go
+  if( ( f->n + len ) > BUFSIZ ) {
+    iovec_t iov[ 2 ] = { { f->buf, f->n }, { ( void* )( p ), len } };
+
+    int r = writev( f->fd, iov, 2 ); f->n = 0;
+
+    return ( r < 0 ) ? 0 : n;
+  }
+
+  for( size_t i = 0; i < len; i++ ) {
+    f->buf[ f->n++ ] = p[ i ];
+  }
+
+  if( fdone( f ) == EOF ) {
+    return 0;
+  }
+
+  return n;
+}
+
+// convert unsigned integer x into base-b ASCII string r (without terminator); return length
+static int utoa( char* r, uint32_t x, uint32_t b, bool upper ) {
+  const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  char t[ 32 ]; int n = 0;
+
+  do {
+    t[ n++ ] = digits[ x % b ]; x /= b;
+  } while( x );
+
+  for( int i = 0; i < n; i++ ) {
+    r[ i ] = t[ n - 1 - i ];
+  }
+
+  return n;
+}
+
+int vfprintf( FILE* f, const char* fmt, va_list args ) {
+  int r = 0;
+
+  for( const char* p = fmt; *p != '\x00'; p++ ) {
+    if( *p != '%' ) {
+      if( fputb( f, *p ) == EOF ) return EOF;
+      r++; continue;
+    }
+
+    // parse flags and width
+
+    bool left = false; char pad = ' '; int width = 0;
+
+    for( p++; ( *p == '-' ) || ( *p == '0' ); p++ ) {
+      if( *p == '-' ) left = true; else pad = '0';
+    }
+    for(    ; ( *p >= '0' ) && ( *p <= '9' ); p++ ) {
+      width = ( width * 10 ) + ( *p - '0' );
+    }
+
+    // convert argument into string x of length n
+
+    char t[ 32 ]; const char* x = t; int n = 0; bool neg = false;
+
+    switch( *p ) {
+      case 'd' :
+      case 'i' : {
+        int v = va_arg( args, int ); neg = ( v < 0 );
+        n = utoa( t, neg ? -( uint32_t )( v ) : ( uint32_t )( v ), 10, false );
+        break;
+      }
+      case 'u' : n = utoa( t, va_arg( args, uint32_t ), 10, false ); break;
+      case 'x' : n = utoa( t, va_arg( args, uint32_t ), 16, false ); break;
+      case 'X' : n = utoa( t, va_arg( args, uint32_t ), 16,  true ); break;
+      case 'c' : t[ n++ ] = ( char )( va_arg( args, int ) );         break;
+      case 's' : {
+        x = va_arg( args, const char* );
+        if( x == NULL ) x = "(null)";
+        while( x[ n ] != '\x00' ) n++;
+        break;
+      }
+      case '\x00' : p--; // fall through: format ends with a lone %
+      default  : t[ n++ ] = '%'; break;
+    }
+
+    // write x, padded to the field width
+
+    int w = ( width > ( n + neg ) ) ? ( width - ( n + neg ) ) : 0;
+
+    if( !left && ( pad == ' ' ) ) for( int i = 0; i < w; i++ ) if( fputb( f, ' ' ) == EOF ) return EOF;
+    if(  neg                    )                              if( fputb( f, '-' ) == EOF ) return EOF;
+    if( !left && ( pad == '0' ) ) for( int i = 0; i < w; i++ ) if( fputb( f, '0' ) == EOF ) return EOF;
+    for( int i = 0; i < n; i++ )                               if( fputb( f, x[ i ] ) == EOF ) return EOF;
+    if(  left                   ) for( int i = 0; i < w; i++ ) if( fputb( f, ' ' ) == EOF ) return EOF;
+
+    r += w + neg + n;
+  }
+
+  if( fdone( f ) == EOF ) {
+    return EOF;
+  }
+
+  return r;
+}
+
+int fprintf( FILE* f, const char* fmt, ... ) {
+  va_list args; va_start( args, fmt );
+  int r = vfprintf( f, fmt, args );
+  va_end( args );
+
+  return r;
+}
+
+int printf( const char* fmt, ... ) {
+  va_list args; va_start( args, fmt );
+  int r = vfprintf( stdout, fmt, args );
+  va_end( args );
+
+  return r;
+}
@@ -8,6 +8,7 @@
 #ifndef __LIBC_H
 #define __LIBC_H
 
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -23,24 +24,57 @@ typedef int pid_t;
  * 2. signal identifiers (as used by the kill system call), 
  * 3. status codes for exit,
  * 4. standard file descriptors (e.g., for read and write system calls),
- * 5. platform-specific constants, which may need calibration (wrt. the
+ *    and origins for lseek,
+ * 5. buffering modes for standard I/O streams,
+ * 6. platform-specific constants, which may need calibration (wrt. the
  *    underlying hardware QEMU is executed on).
  *
  * They don't *precisely* match the standard C library, but are intended
  * to act as a limited model of similar concepts.
  */
 
-#define SYS_YIELD      ( 0x00 )
-#define SYS_WRITE      ( 0x01 )
-#define SYS_READ       ( 0x02 )
-#define SYS_FORK       ( 0x03 )
-#define SYS_EXIT       ( 0x04 )
-#define SYS_EXEC       ( 0x05 )
-#define SYS_KILL       ( 0x06 )
-#define SYS_NICE       ( 0x07 )
-#define SYS_SHM_OPEN   ( 0x08 )
-#define SYS_MMAP       ( 0x09 )
-#define SYS_SHM_UNLINK ( 0x0A )
+#define SYS_YIELD            ( 0x00 )
+#define SYS_WRITE            ( 0x01 )
+#define SYS_READ             ( 0x02 )
+#define SYS_FORK             ( 0x03 )
+#define SYS_EXIT             ( 0x04 )
+#define SYS_EXEC             ( 0x05 )
+#define SYS_KILL             ( 0x06 )
+#define SYS_NICE             ( 0x07 )
+#define SYS_SHM_OPEN         ( 0x08 )
+#define SYS_MMAP             ( 0x09 )
+#define SYS_SHM_UNLINK       ( 0x0A )
+#define SYS_WRITEV           ( 0x0B )
+#define SYS_READV            ( 0x0C )
+#define SYS_OPEN             ( 0x0D )
+#define SYS_CLOSE            ( 0x0E )
+#define SYS_LSEEK            ( 0x0F )
+#define SYS_PIPE             ( 0x10 )
+#define SYS_DUP2             ( 0x11 )
+#define SYS_SPAWN            ( 0x12 )
+#define SYS_THREAD_CREATE    ( 0x13 )
+#define SYS_THREAD_JOIN      ( 0x14 )
+#define SYS_SCHED_SETCLASS   ( 0x15 )
+#define SYS_SCHED_SETATTR    ( 0x16 )
+#define SYS_SCHED_SETSLICE   ( 0x17 )
+#define SYS_SCHED_SETQUANTUM ( 0x18 )
+#define SYS_GETSTATS         ( 0x19 )
+#define SYS_CYCLES           ( 0x1A )
+#define SYS_TRACE            ( 0x1B )
+#define SYS_PROF             ( 0x1C )
+#define SYS_GETPID           ( 0x1D )
+
+#define SCHED_FAIR     ( 0 ) // weighted fair-share scheduling class (default)
+#define SCHED_PRIO     ( 1 ) //    priority+age  scheduling class
+#define SCHED_EDF      ( 2 ) // earliest deadline first scheduling class, for processes with a runtime, deadline and period
+
+#define TRACE_STOP     ( 0 ) // stop   recording trace events
+#define TRACE_START    ( 1 ) // start  recording trace events
+#define TRACE_DUMP     ( 2 ) // drain  trace events recorded to the trace UART (i.e., UART3)
+
+#define PROF_STOP      ( 0 ) // stop   sampling
+#define PROF_START     ( 1 ) // start  sampling, every y >= 100 cycles (or per the default iff. y = 0)
+#define PROF_DUMP      ( 2 ) // drain  samples taken to the trace UART (i.e., UART3)
 
 #define SIG_TERM       ( 0x00 )
 #define SIG_QUIT       ( 0x01 )
@@ -52,6 +86,89 @@ typedef int pid_t;
 #define STDOUT_FILENO  ( 1 )
 #define STDERR_FILENO  ( 2 )
 
+#define SEEK_SET       ( 0 )
+#define SEEK_CUR       ( 1 )
+
+#define _IOFBF         ( 0 ) // flush when full
+#define _IOLBF         ( 1 ) // flush when full, or after writing a newline
+#define _IONBF         ( 2 ) // flush after every call
+
+#define BUFSIZ         ( 128 )
+#define EOF            ( -1 )
+
+#define PROC_TLS       ( 0x00000200 ) // size of TLS area (per the kernel)
+#define MAX_IOV        ( 16 )         // maximum number of buffers per readv or writev (per the kernel)
+#define MAX_ARGS       (  8 )         // maximum number of arguments per spawn (per the kernel)
+
+// Define a type that captures one buffer in a scatter/gather (i.e., vectored) read or write.
+
+typedef struct {
+    void* iov_base; // address of buffer
+  size_t  iov_len;  // length  of buffer
+} iovec_t;
+
+// Define a type that captures the scheduling class and parameters of a process (per the kernel); times are in cycles, i.e., 1 MHz.
+
+typedef struct {
+       int  policy;   // scheduling class
+       int  priority; // base priority, iff. not SCHED_EDF
+  uint32_t  runtime;  // SCHED_EDF: runtime  per period
+  uint32_t  deadline; // SCHED_EDF: deadline relative to start of period
+  uint32_t  period;   // SCHED_EDF: period
+  uint32_t  slice;    // time slice, or 0 iff. per class, iff. not SCHED_EDF
+} sched_attr_t;
+
+// Define a type that captures the accounting of a process (per the kernel); times are in cycles of the PMU cycle counter, i.e., of the CPU.
+
+typedef struct {
+  uint64_t     user; // cycles executing in USR mode
+  uint64_t      sys; // cycles executing in the kernel on behalf of the process
+  uint64_t   instrs; // instructions executed, in USR mode or in the kernel
+  uint32_t switches; // number of times dispatched, i.e., context switched to
+  uint32_t syscalls; // number of system calls made
+  uint32_t   faults; // number of page faults raised
+} stats_t;
+
+/* A program linked into the kernel registers itself by name using
+ * PROGRAM, e.g.,
+ *
+ * PROGRAM( "P3", main_P3, 0x0400, 1 );
+ *
+ * declares a record (per the kernel) st. exec( "P3" ) executes main_P3,
+ * with a stack of 0x400 bytes and a default base priority of 1.
+ */
+
+typedef struct {
+  const char*     name;   // name, as passed to exec
+       void ( *entry )(); // entry point
+   uint32_t      stack;   // stack size required (at most 4 KiB, minus the TLS and argument areas)
+        int   priority;   // default base priority
+} program_t;
+
+#define PROGRAM( name, entry, stack, priority ) \
+  static const program_t __program_##entry __attribute__(( section( ".programs" ), used )) = { name, &entry, stack, priority }
+
+/* A FILE buffers bytes written to a file descriptor, st. one write system
+ * call can carry many small writes (e.g., every field of a printf).  Note
+ * that
+ *
+ * - the buffer is stored inline rather than via a pointer, so a FILE is
+ *   still valid after fork copies it, and
+ * - since every process shares the same global variables, the standard
+ *   streams are kept in the TLS area the kernel reserves for each process;
+ *   this is why stdout and stderr are function calls rather than variables.
+ */
+
+typedef struct {
+     int   fd;            // file descriptor written to
+     int mode;            // buffering mode
+  size_t    n;            // number of bytes buffered
+    char  buf[ BUFSIZ ];  // buffered bytes
+} FILE;
+
+#define stdout ( stdio( STDOUT_FILENO ) )
+#define stderr ( stdio( STDERR_FILENO ) )
+
 // convert ASCII string x into integer r
 extern int  atoi( char* x        );
 // convert integer x into ASCII string r
@@ -65,27 +182,93 @@ extern int write( int fd, const void* x, size_t n );
 // read  n bytes into x from the file descriptor fd; return bytes read
 extern int  read( int fd,       void* x, size_t n );
 
+// write n buffers described by iov to   the file descriptor fd, in one (atomic iff. small) operation; return bytes written
+extern int writev( int fd, const iovec_t* iov, int n );
+// read  n buffers described by iov from the file descriptor fd, filling each in turn; return bytes read
+extern int  readv( int fd, const iovec_t* iov, int n );
+
+// open the device named x (i.e., "tty0", "tty1" or "disk"); return file descriptor
+extern int  open( const char* x );
+// close the file descriptor fd
+extern int close( int fd );
+// set offset of the file descriptor fd to x, relative to whence (i.e., SEEK_SET or SEEK_CUR); return new offset
+extern int lseek( int fd, int x, int whence );
+
+// create a pipe, st. fd[ 0 ] is the read end and fd[ 1 ] is the write end
+extern int pipe( int fd[ 2 ] );
+// make file descriptor y refer to the same file as x, closing y first iff. it is open; return y
+extern int dup2( int x, int y );
+
 // perform fork, returning 0 iff. child or > 0 iff. parent process
 extern int  fork();
-// perform exit, i.e., terminate process with status x
+// perform exit, i.e., terminate process (and each of its threads) with status x, or only the thread iff. called by one
 extern void exit(       int   x );
-// perform exec, i.e., start executing program at address x
-extern void exec( const void* x );
+// perform exec, i.e., start executing program named x (registered, or else loaded from disk); return -1 iff. there is none
+extern int  exec( const char* x );
+
+// perform spawn, i.e., create a process executing program named x, with base priority (or the default iff. < 0) and
+// a copy of the NULL-terminated arguments argv (passed as argc and argv); standard files (only) are shared as by fork; return PID
+extern int  spawn( const char* x, int priority, char* const argv[] );
+
+// create a thread executing fn( x ), which shares the address space and open files of the executing process; return thread ID
+extern int  thread_create( void ( *fn )( void* ), void* x );
+// wait until thread t terminates (i.e., returns from fn, or calls exit)
+extern int  thread_join( int t );
 
 // for process identified by pid, send signal of x
 extern int  kill( pid_t pid, int x );
-// for process identified by pid, set  priority to x
+// for process identified by pid, set  priority to x (which, for SCHED_FAIR, selects its share of the CPU)
 extern void nice( pid_t pid, int x );
+// for process identified by pid, set  scheduling class to x (i.e., SCHED_FAIR or SCHED_PRIO); return -1 iff. invalid
+extern int  sched_setclass( pid_t pid, int x );
+// for process identified by pid, set  scheduling class and parameters per x; return -1 iff. invalid, or (for SCHED_EDF) not admitted
+extern int  sched_setattr( pid_t pid, const sched_attr_t* x );
+// for process identified by pid, set  time slice to x cycles (e.g., long for batch processing), or per class iff. x = 0; return -1 iff. invalid
+extern int  sched_setslice( pid_t pid, uint32_t x );
+// for scheduling class c (i.e., SCHED_FAIR or SCHED_PRIO), set quantum, from which time slices are computed, to x cycles; return -1 iff. invalid
+extern int  sched_setquantum( int c, uint32_t x );
+// for process identified by pid, or (iff. pid = -1 - c) the idle process of CPU c, read accounting into x; return -1 iff. invalid
+extern int  getstats( pid_t pid, stats_t* x );
+// control kernel event tracing per x (i.e., TRACE_STOP, TRACE_START or TRACE_DUMP); return -1 iff. invalid, or (for TRACE_DUMP) a previous dump is still being written
+extern int  trace( int x );
+// control sampling profiler per x (i.e., PROF_STOP, PROF_START or PROF_DUMP) and y (i.e., a period in cycles); return -1 iff. invalid, or (for PROF_DUMP) a previous dump is still being written
+extern int  prof( int x, uint32_t y );
+// return PID of the executing process (i.e., of the process a thread belongs to)
+extern pid_t getpid();
 
-// allocate n-byte shared memory region and return file descriptor
+// allocate n-byte shared memory region and return file descriptor (the region is deallocated once every descriptor is closed)
 extern int shm_open( uint32_t size );
 // return pointer to shared memory
 extern void* mmap( int fd );
-// deallocate n-byte shared memory region
+// reset contents of shared memory region
 extern void shm_unlink( int fd );
 
+// return the standard stream for file descriptor fd, i.e., STDOUT_FILENO or STDERR_FILENO
+extern FILE*  stdio( int fd );
+
+// set buffering mode of stream f to mode, i.e., _IOFBF, _IOLBF or _IONBF
+extern int  setvbuf( FILE* f, int mode );
+// write whatever is buffered in stream f to the underlying file descriptor
+extern int   fflush( FILE* f );
+
+// write byte c to stream f
+extern int    fputc( int c, FILE* f );
+// write string x to stream f
+extern int    fputs( const char* x, FILE* f );
+// write n items of size bytes from x to stream f; return items written
+extern size_t fwrite( const void* x, size_t size, size_t n, FILE* f );
+
+// write formatted string to stream f, per a (limited) subset of printf: %[-0][width](d|i|u|x|X|c|s|%)
+extern int  vfprintf( FILE* f, const char* fmt, va_list args );
+// write formatted string to stream f
+extern int   fprintf( FILE* f, const char* fmt, ... );
+// write formatted string to stdout
+extern int    printf(          const char* fmt, ... );
+
 // do no operations on this thread for s seconds
 extern void sleep( int s );
+// read the PMU cycle counter of whichever CPU executes the process (via a system call, since USR mode cannot access the PMU), which wraps every 2^32 cycles
+extern uint32_t cycles();
 // release or signal a semaphore
 extern void sem_post( const void* x );
 // lock a semaphore or wait
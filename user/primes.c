@@ -0,0 +1,133 @@
+/* Copyright (C) 2017 Daniel Page <csdsp@bristol.ac.uk>
+ *
+ * Use of this source code is restricted per the CC BY-NC-ND license, a copy of 
+ * which can be found via http://creativecommons.org (and should be included as 
+ * LICENSE.txt within the associated archive or repository).
+ */
+
+#include "primes.h"
+
+#define TEST( x, i ) ( ( ( x )[ ( i ) >> 5 ] >> ( ( i ) & 31 ) ) & 1 )
+#define  CLR( x, i ) ( ( x )[ ( i ) >> 5 ] &= ~( 1 << ( ( i ) & 31 ) ) )
+
+// Clamp y to [lo, hi]
+static uint32_t primes_clamp( uint32_t y, uint32_t lo, uint32_t hi ) {
+  return ( y < lo ) ? lo : ( y > hi ) ? hi : y;
+}
+
+bool     primes_init ( primes_t* x, uint32_t* bits, uint32_t lo, uint32_t hi ) {
+  if( hi > ( PRIMES_ROOT * PRIMES_ROOT ) || lo > hi ) {
+    return false;
+  }
+
+  x->lo   = lo & ~63;
+  x->hi   = hi;
+  x->bits = bits;
+
+  // Sieve base bitmap (which covers each odd number < PRIMES_ROOT), starting with every odd number other than 1
+  for( int i = 0; i < ( PRIMES_ROOT / 64 ); i++ ) {
+    x->base[ i ] = 0xFFFFFFFF;
+  }
+
+  CLR( x->base, 0 );
+
+  for( uint32_t p = 3; ( p * p ) < PRIMES_ROOT; p += 2 ) {
+    if( TEST( x->base, p >> 1 ) ) {
+      for( uint32_t m = p * p; m < PRIMES_ROOT; m += 2 * p ) CLR( x->base, m >> 1 );
+    }
+  }
+
+  return true;
+}
+
+void     primes_sieve( primes_t* x, uint32_t a, uint32_t b ) {
+  a = primes_clamp( a, x->lo, x->hi );
+  b = primes_clamp( b, x->lo, x->hi );
+
+  for( uint32_t s = a; s < b; s += PRIMES_SEGMENT ) {
+    uint32_t e = ( ( b - s ) > PRIMES_SEGMENT ) ? ( s + PRIMES_SEGMENT ) : b;
+
+    // Start with every odd number in the segment, other than 1
+    uint32_t* w = &x->bits[ ( s - x->lo ) / 64 ];
+
+    for( uint32_t i = 0; i < ( ( e - s + 63 ) / 64 ); i++ ) {
+      w[ i ] = 0xFFFFFFFF;
+    }
+
+    if( s <= 1 && 1 < e ) {
+      CLR( x->bits, ( 1 - x->lo ) >> 1 );
+    }
+
+    // Cross off odd multiples of each base prime p, starting from p^2 (since any smaller multiple has a smaller factor)
+    for( uint32_t p = 3; ( p * p ) < e; p += 2 ) {
+      if( !TEST( x->base, p >> 1 ) ) {
+        continue;
+      }
+
+      uint32_t m = p * p;
+
+      if( m < s ) {
+        m = s + ( ( p - ( s % p ) ) % p ); m += ( m & 1 ) ? 0 : p;
+      }
+
+      for( ; m < e; m += 2 * p ) {
+        CLR( x->bits, ( m - x->lo ) >> 1 );
+      }
+    }
+  }
+}
+
+bool     primes_test ( const primes_t* x, uint32_t y ) {
+  if( y < x->lo || y >= x->hi ) {
+    return false;
+  }
+
+  return ( y & 1 ) ? TEST( x->bits, ( y - x->lo ) >> 1 ) : ( y == 2 );
+}
+
+uint32_t primes_count( const primes_t* x, uint32_t a, uint32_t b ) {
+  a = primes_clamp( a, x->lo, x->hi );
+  b = primes_clamp( b, x->lo, x->hi );
+
+  if( a >= b ) {
+    return 0;
+  }
+
+  // Count bits [i, j), i.e., for odd numbers in [a, b): whole words via bits_weight, and masked words at either end
+  uint32_t i = ( a - x->lo ) >> 1, j = ( b - x->lo ) >> 1, r = ( a <= 2 && 2 < b ) ? 1 : 0;
+
+  while( i < j && ( i & 31 ) != 0 ) {
+    r += TEST( x->bits, i ); i++;
+  }
+
+  r += bits_weight( &x->bits[ i >> 5 ], ( j - i ) >> 5 ); i += ( j - i ) & ~31;
+
+  while( i < j ) {
+    r += TEST( x->bits, i ); i++;
+  }
+
+  return r;
+}
+
+uint32_t primes_next ( const primes_t* x, uint32_t a ) {
+  a = primes_clamp( a, x->lo, x->hi );
+
+  if( a <= 2 && 2 < x->hi ) {
+    return 2;
+  }
+
+  // Scan from the bit for a a word at a time, skipping any word with no bit set, then take the least bit set via ctz
+  uint32_t i = ( a - x->lo ) >> 1, n = ( x->hi - x->lo ) >> 1;
+
+  while( i < n ) {
+    uint32_t t = x->bits[ i >> 5 ] >> ( i & 31 );
+
+    if( t != 0 ) {
+      i += __builtin_ctz( t ); break;
+    }
+
+    i = ( i + 32 ) & ~31;
+  }
+
+  return ( i < n ) ? ( x->lo + ( 2 * i ) + 1 ) : 0;
+}
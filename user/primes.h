@@ -0,0 +1,58 @@
+/* Copyright (C) 2017 Daniel Page <csdsp@bristol.ac.uk>
+ *
+ * Use of this source code is restricted per the CC BY-NC-ND license, a copy of 
+ * which can be found via http://creativecommons.org (and should be included as 
+ * LICENSE.txt within the associated archive or repository).
+ */
+
+#ifndef __PRIMES_H
+#define __PRIMES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bits.h"
+
+/* The functions below find every prime in a range [lo, hi) using a
+ * segmented sieve of Eratosthenes.  The result is a bitmap with 1 bit per
+ * odd number, i.e., bit i captures whether lo + 2i + 1 is prime (where
+ * lo is rounded down to a multiple of 64, st. each word covers 64
+ * numbers); 2 is dealt with as a special case.  Note that
+ *
+ * - the range is sieved PRIMES_SEGMENT numbers at a time, st. the part
+ *   of the bitmap being sieved stays in the L1 data cache while every
+ *   base prime (i.e., each odd prime up to sqrt( hi ), which are found
+ *   first, by primes_init) crosses off its multiples,
+ * - any sub-range whose bounds are multiples of 64 numbers from lo can be
+ *   sieved independently, e.g., by a different process (over a bitmap
+ *   in a shm region), since no two such sub-ranges share a word, and
+ * - the bitmap is caller-allocated (of PRIMES_WORDS( lo, hi ) words), and
+ *   the library itself has no state, st. it is safe to use from several
+ *   processes linked into the kernel image at once.
+ */
+
+#define PRIMES_SEGMENT ( 16384 ) // numbers sieved at a time, i.e., 1 KiB of bitmap
+#define PRIMES_ROOT    (  4096 ) // limit on base primes, st. hi <= PRIMES_ROOT^2 = 2^24
+
+#define PRIMES_WORDS( lo, hi ) ( ( ( hi ) - ( ( lo ) & ~63 ) + 63 ) / 64 )
+
+typedef struct {
+  uint32_t    lo, hi;                      // range, with lo rounded down to a multiple of 64
+  uint32_t* bits;                          // bitmap, st. bit i is set iff. lo + 2i + 1 is prime
+  uint32_t  base[ PRIMES_ROOT / 64 ];      // base bitmap, st. bit i is set iff. 2i + 1 is prime
+} primes_t;
+
+// initialise x to sieve [lo, hi) into bitmap bits, finding the base primes; return false iff. hi is too large
+extern bool     primes_init ( primes_t* x, uint32_t* bits, uint32_t lo, uint32_t hi );
+// sieve sub-range [a, b) of x, where a (and b, unless b = hi) is a multiple of 64 numbers from lo
+extern void     primes_sieve( primes_t* x, uint32_t a, uint32_t b );
+
+// return true iff. y is prime, for y in the range of (sieved) x
+extern bool     primes_test ( const primes_t* x, uint32_t y );
+// return number of primes in [a, b), within the range of (sieved) x
+extern uint32_t primes_count( const primes_t* x, uint32_t a, uint32_t b );
+// return least prime >= a, within the range of (sieved) x, or 0 iff. there is none
+extern uint32_t primes_next ( const primes_t* x, uint32_t a );
+
+#endif